@@ -0,0 +1,129 @@
+#ifndef ASMSINK_HPP
+#define ASMSINK_HPP
+
+#include <string>
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+// Tujuan output assembly. Codegen menulis teks per fungsi langsung ke sink,
+// jadi seluruh program tidak pernah ada di memori sekaligus.
+class AsmSink {
+public:
+    virtual ~AsmSink() = default;
+    virtual void write(const char* data, size_t n) = 0;
+    virtual void flush() {}
+
+    void write(const std::string& s) { write(s.data(), s.size()); }
+
+    void line(const std::string& s) {
+        write(s.data(), s.size());
+        write("\n", 1);
+    }
+};
+
+// Untuk --debug dan pemakai yang butuh hasil sebagai string.
+class StringSink : public AsmSink {
+    std::string out;
+
+public:
+    void write(const char* data, size_t n) override { out.append(data, n); }
+    const std::string& str() const { return out; }
+};
+
+// Buffer tetap yang di-flush ke file descriptor. Potongan besar (teks satu
+// fungsi) ditulis bersama isi buffer dalam satu writev tanpa disalin dulu.
+class FileSink : public AsmSink {
+    static constexpr size_t BufferSize = 256 * 1024;
+
+    int fd;
+    std::string path;
+    std::string buffer;
+
+public:
+    explicit FileSink(const std::string& p) : path(p) {
+        fd = ::open(p.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) throw std::runtime_error("Cannot write to output file: " + p);
+        buffer.reserve(BufferSize);
+    }
+
+    ~FileSink() override {
+        if (fd < 0) return;
+        try { flush(); } catch (...) {}
+        ::close(fd);
+    }
+
+    FileSink(const FileSink&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+
+    void write(const char* data, size_t n) override {
+        if (buffer.size() + n <= BufferSize) {
+            buffer.append(data, n);
+            return;
+        }
+        if (n < BufferSize) {
+            flush();
+            buffer.append(data, n);
+            return;
+        }
+        struct iovec iov[2] = {
+            {const_cast<char*>(buffer.data()), buffer.size()},
+            {const_cast<char*>(data), n},
+        };
+        writeAll(iov, 2);
+        buffer.clear();
+    }
+
+    void flush() override {
+        if (buffer.empty()) return;
+        struct iovec iov = {const_cast<char*>(buffer.data()), buffer.size()};
+        writeAll(&iov, 1);
+        buffer.clear();
+    }
+
+    // Flush lalu tutup; error tulis dilaporkan di sini, bukan di destruktor.
+    void close() {
+        flush();
+        int rc = ::close(fd);
+        fd = -1;
+        if (rc != 0) fail();
+    }
+
+    // Codegen gagal: jangan tinggalkan file setengah jadi.
+    void discard() {
+        buffer.clear();
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+        ::unlink(path.c_str());
+    }
+
+private:
+    void writeAll(struct iovec* iov, int count) {
+        while (count > 0) {
+            ssize_t n = ::writev(fd, iov, count);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                fail();
+            }
+            // writev boleh menulis sebagian; geser iovec yang tersisa.
+            while (count > 0 && (size_t)n >= iov->iov_len) {
+                n -= iov->iov_len;
+                ++iov;
+                --count;
+            }
+            if (count > 0) {
+                iov->iov_base = (char*)iov->iov_base + n;
+                iov->iov_len -= n;
+            }
+        }
+    }
+
+    [[noreturn]] void fail() {
+        throw std::runtime_error("Failed writing " + path + ": " + std::strerror(errno));
+    }
+};
+
+#endif
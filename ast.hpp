@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include "types.hpp"
 
 enum class NodeKind {
     Program, FunctionDef, InitBlock, TypeInit,
@@ -15,7 +17,10 @@ enum class NodeKind {
 
 struct Node {
     NodeKind kind;
-    int line;
+    int line = 0;
+    int column = 0;
+    bool isVolatile = false; // akses MMIO: tidak boleh digabung/dihapus
+    TypeId resolvedType = NoType; // diisi SemanticChecker
     virtual ~Node() {}
 };
 
@@ -31,8 +36,10 @@ struct ProgramNode : Node {
 
 struct ParamNode : Node {
     std::string name;
-    std::string type;
-    ParamNode(const std::string& n, const std::string& t, int l) : name(n), type(t) { kind = NodeKind::Param; line = l; }
+    TypeId type;
+    int sym = -1;   // id nama dari Interner
+    int local = -1; // nomor binding lokal dalam fungsi
+    ParamNode(const std::string& n, TypeId t, int l) : name(n), type(t) { kind = NodeKind::Param; line = l; }
 };
 
 struct BlockNode : Node {
@@ -43,15 +50,17 @@ struct BlockNode : Node {
 struct FunctionDefNode : Node {
     std::string name;
     std::vector<ParamNode> params;
-    std::string returnType;
+    TypeId returnType = NoType;
     NodePtr body;
+    int localCount = 0;
+    bool checked = false; // hasil checker diambil dari cache modul
     FunctionDefNode() { kind = NodeKind::FunctionDef; }
 };
 
 struct TypeInitNode : Node {
     std::string name;
-    std::string type;
-    TypeInitNode(const std::string& n, const std::string& t, int l) : name(n), type(t) {
+    TypeId type;
+    TypeInitNode(const std::string& n, TypeId t, int l) : name(n), type(t) {
         kind = NodeKind::TypeInit;
         line = l;
     }
@@ -59,7 +68,9 @@ struct TypeInitNode : Node {
 
 struct StructDefNode : Node {
     std::string name;
-    std::vector<std::pair<std::string, std::string>> fields;
+    std::vector<std::pair<std::string, TypeId>> fields;
+    std::vector<std::pair<int, int>> fieldPos; // baris/kolom tiap field
+    TypeId id = NoType;
     int align = 0; 
     bool packed = false;
     uint64_t baseAddress = 0;
@@ -71,9 +82,11 @@ struct StructDefNode : Node {
 
 struct DeclStmtNode : Node {
     std::string name;
-    std::string type;
+    TypeId type;
     NodePtr expr;
-    DeclStmtNode(const std::string& n, const std::string& t, NodePtr e)
+    int sym = -1;
+    int local = -1;
+    DeclStmtNode(const std::string& n, TypeId t, NodePtr e)
         : name(n), type(t), expr(e) {
         kind = NodeKind::Decl;
     }
@@ -143,11 +156,14 @@ struct ArrayIndexNode : Node {
     ArrayIndexNode(NodePtr arr, NodePtr idx) : array(arr), index(idx) {
         kind = NodeKind::ArrayIndex;
         line = arr->line;
+        column = arr->column;
     }
 };
 
 struct VarRefNode : Node {
     std::string name;
+    int sym = -1;
+    int local = -1; // -1: bukan variabel lokal (mis. struct at())
     VarRefNode(const std::string& v, int l) : name(v) {
         kind = NodeKind::VarRef;
         line = l;
@@ -157,6 +173,8 @@ struct VarRefNode : Node {
 struct CallNode : Node {
     std::string name;
     std::vector<NodePtr> args;
+    bool builtin = false; // intrinsik (vload, atomic_add, ...), ditandai checker
+    std::string order;    // intrinsik atomik: relaxed/acquire/release/acq_rel/seq_cst
     CallNode(const std::string& n, int l) : name(n) {
         kind = NodeKind::Call;
         line = l;
@@ -165,6 +183,7 @@ struct CallNode : Node {
 
 struct StructInitNode : Node {
     std::string name;
+    std::vector<NodePtr> args;
     StructInitNode(const std::string& n, int l) : name(n) {
         kind = NodeKind::StructInit;
         line = l;
@@ -177,6 +196,7 @@ struct UnaryOpNode : Node {
     UnaryOpNode(const std::string& o, NodePtr r) : op(o), rhs(r) {
         kind = NodeKind::UnaryOp;
         line = r->line;
+        column = r->column;
     }
 };
 
@@ -186,6 +206,7 @@ struct BinaryOpNode : Node {
     BinaryOpNode(const std::string& o, NodePtr l, NodePtr r) : op(o), lhs(l), rhs(r) {
         kind = NodeKind::BinaryOp;
         line = l->line;
+        column = l->column;
     }
 };
 
@@ -195,6 +216,7 @@ struct PointerAssignNode : Node {
     PointerAssignNode(NodePtr ptr, NodePtr val) : pointerExpr(ptr), valueExpr(val) {
         kind = NodeKind::PointerAssign;
         line = ptr->line;
+        column = ptr->column;
     }
 };
 
@@ -204,7 +226,94 @@ struct MemberAccessNode : Node {
     MemberAccessNode(NodePtr obj, const std::string& fld) : object(obj), field(fld) {
         kind = NodeKind::MemberAccess;
         line = obj->line;
+        column = obj->column;
     }
 };
 
+// Panggil f untuk setiap anak langsung dari n (statement maupun ekspresi).
+// Anak diberikan sebagai referensi ke slotnya, jadi f boleh menggantinya.
+template<typename F>
+void visitChildren(const NodePtr& n, F&& f) {
+    if (!n) return;
+    auto visit = [&](NodePtr& c) { if (c) f(c); };
+    switch (n->kind) {
+        case NodeKind::Program:
+            for (auto& d : static_cast<ProgramNode*>(n.get())->topDefs) visit(d);
+            break;
+        case NodeKind::FunctionDef:
+            visit(static_cast<FunctionDefNode*>(n.get())->body);
+            break;
+        case NodeKind::Block:
+            for (auto& s : static_cast<BlockNode*>(n.get())->statements) visit(s);
+            break;
+        case NodeKind::Decl:
+            visit(static_cast<DeclStmtNode*>(n.get())->expr);
+            break;
+        case NodeKind::Assign: {
+            auto a = static_cast<AssignStmtNode*>(n.get());
+            visit(a->lhs);
+            visit(a->expr);
+            break;
+        }
+        case NodeKind::ExprStmt:
+            visit(static_cast<ExprStmtNode*>(n.get())->expr);
+            break;
+        case NodeKind::If: {
+            auto i = static_cast<IfStmtNode*>(n.get());
+            for (auto& [cond, blk] : i->branches) {
+                visit(cond);
+                visit(blk);
+            }
+            visit(i->elseBlock);
+            break;
+        }
+        case NodeKind::While: {
+            auto w = static_cast<WhileStmtNode*>(n.get());
+            visit(w->cond);
+            visit(w->block);
+            break;
+        }
+        case NodeKind::Return:
+            visit(static_cast<ReturnStmtNode*>(n.get())->expr);
+            break;
+        case NodeKind::Inj:
+            for (auto& v : static_cast<InjStmtNode*>(n.get())->values) visit(v);
+            break;
+        case NodeKind::BinaryOp: {
+            auto b = static_cast<BinaryOpNode*>(n.get());
+            visit(b->lhs);
+            visit(b->rhs);
+            break;
+        }
+        case NodeKind::UnaryOp:
+            visit(static_cast<UnaryOpNode*>(n.get())->rhs);
+            break;
+        case NodeKind::Call:
+            for (auto& arg : static_cast<CallNode*>(n.get())->args) visit(arg);
+            break;
+        case NodeKind::StructInit:
+            for (auto& arg : static_cast<StructInitNode*>(n.get())->args) visit(arg);
+            break;
+        case NodeKind::PointerAssign: {
+            auto p = static_cast<PointerAssignNode*>(n.get());
+            visit(p->pointerExpr);
+            visit(p->valueExpr);
+            break;
+        }
+        case NodeKind::MemberAccess:
+            visit(static_cast<MemberAccessNode*>(n.get())->object);
+            break;
+        case NodeKind::ArrayLiteral:
+            for (auto& el : static_cast<ArrayLiteralNode*>(n.get())->elements) visit(el);
+            break;
+        case NodeKind::ArrayIndex: {
+            auto ai = static_cast<ArrayIndexNode*>(n.get());
+            visit(ai->array);
+            visit(ai->index);
+            break;
+        }
+        default: break;
+    }
+}
+
 #endif
@@ -1,7 +1,8 @@
 #!/bin/bash
 echo "🔧 Building QueLang compiler..."
-g++ -std=c++17 main.cpp -o quelang
-chmod +x quelang 
+g++ -std=c++17 -pthread main.cpp -o quelang &&
+g++ -std=c++17 -O2 quesim.cpp -o quesim &&
+chmod +x quelang quesim
 
 if [ $? -eq 0 ]; then
     echo "✅ Build succeeded: ./quelang"
@@ -11,6 +12,8 @@ if [ $? -eq 0 ]; then
     echo " ./quelang input.q output.s"
     echo "for debug :"
     echo " ./quelang --debug input.q output.s"
+    echo "run + profile (simulator) :"
+    echo " ./quesim output.s"
     echo " "
     echo "qc0.7 --Alpha"
 else
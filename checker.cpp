@@ -4,85 +4,264 @@
 #include <stdexcept> 
 #include <string> 
 #include <memory>
+#include <vector>
+#include <thread>
+#include <atomic>
 
-class SemanticChecker { struct VarInfo { std::string type; bool isDefined = false; };
+#include "symbols.hpp"
+#include "diagnostics.hpp"
+#include "types.hpp"
 
-std::unordered_map<std::string, VarInfo> vars;
-std::unordered_map<std::string, std::string> functions;
-std::unordered_map<std::string, std::unordered_map<std::string, std::string>> structFields;
+class SemanticChecker {
+    struct VarInfo {
+        TypeId type;
+        int local;
+    };
 
-public: void check(std::shared_ptr<ProgramNode> program) { for (auto& def : program->topDefs) { if (def->kind == NodeKind::FunctionDef) { auto fn = std::dynamic_pointer_cast<FunctionDefNode>(def); functions[fn->name] = fn->returnType; } else if (def->kind == NodeKind::StructDef) { auto s = std::dynamic_pointer_cast<StructDefNode>(def); for (auto& field : s->fields) { structFields[s->name][field.first] = field.second; } } }
+    // State milik satu fungsi; tiap worker punya salinannya sendiri.
+    struct FunctionScope {
+        ScopedSymbolTable<VarInfo> scopes;
+        int nextLocal = 0;
+        std::vector<Diagnostic> errors;
+    };
 
-for (auto& def : program->topDefs) {
-        if (def->kind == NodeKind::FunctionDef) {
-            checkFunction(std::dynamic_pointer_cast<FunctionDefNode>(def));
+    // Tabel global: hanya ditulis di fase pertama, sesudahnya read-only.
+    Interner names;
+    TypeTable& types;
+    std::unordered_map<std::string, TypeId> functions;
+    std::unordered_map<std::string, TypeId> structsByName;
+    std::unordered_map<TypeId, std::unordered_map<std::string, TypeId>> structFields;
+    std::unordered_map<std::string, TypeId> mmioStructs; // struct dengan at(alamat)
+
+    int jobs;
+    Diagnostics* diags;
+
+public:
+    // jobs = 0 memakai semua core. Tanpa diags, error pertama langsung dilempar.
+    explicit SemanticChecker(TypeTable& types, int jobs = 1, Diagnostics* diags = nullptr)
+        : types(types), jobs(jobs), diags(diags) {}
+
+    void check(std::shared_ptr<ProgramNode> program) {
+        // Error deklarasi (tipe yang tidak dikenal) per definisi top-level.
+        std::vector<std::vector<Diagnostic>> declErrors(program->topDefs.size());
+        for (size_t k = 0; k < program->topDefs.size(); ++k) {
+            auto& def = program->topDefs[k];
+            if (def->kind == NodeKind::FunctionDef) {
+                auto fn = std::dynamic_pointer_cast<FunctionDefNode>(def);
+                functions[fn->name] = fn->returnType;
+                if (!fn->checked) internNames(fn);
+                for (auto& param : fn->params) checkKnown(declErrors[k], param.type, param.line, param.column);
+                checkKnown(declErrors[k], fn->returnType, fn->line, fn->column);
+            } else if (def->kind == NodeKind::StructDef) {
+                auto s = std::dynamic_pointer_cast<StructDefNode>(def);
+                auto& fields = structFields[types.canonical(s->id)];
+                for (size_t f = 0; f < s->fields.size(); ++f) {
+                    fields[s->fields[f].first] = s->fields[f].second;
+                    checkKnown(declErrors[k], s->fields[f].second, s->fieldPos[f].first, s->fieldPos[f].second);
+                }
+                structsByName[s->name] = s->id;
+                if (s->baseAddress) mmioStructs[s->name] = s->id;
+            } else if (def->kind == NodeKind::TypeInit) {
+                checkKnown(declErrors[k], std::static_pointer_cast<TypeInitNode>(def)->type, def->line, def->column);
+            }
+        }
+
+        // Statement yang gagal di-parse sudah dibuang parser; sisanya tetap dicek.
+        // Fungsi yang hasil ceknya diambil dari cache modul dilewati.
+        std::vector<std::pair<size_t, std::shared_ptr<FunctionDefNode>>> fns;
+        for (size_t k = 0; k < program->topDefs.size(); ++k) {
+            auto& def = program->topDefs[k];
+            if (def->kind != NodeKind::FunctionDef) continue;
+            auto fn = std::dynamic_pointer_cast<FunctionDefNode>(def);
+            if (!fn->checked) fns.emplace_back(k, fn);
+        }
+
+        // Body fungsi saling bebas setelah signature terkumpul; error dilaporkan
+        // menurut urutan sumber, sama seperti mode sekuensial.
+        std::vector<std::vector<Diagnostic>> errors(program->topDefs.size());
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            FunctionScope fs;
+            for (size_t i; (i = next.fetch_add(1)) < fns.size();) {
+                fs.errors.clear();
+                checkFunction(fs, fns[i].second);
+                errors[fns[i].first] = std::move(fs.errors);
+            }
+        };
+
+        int workers = jobs > 0 ? jobs : (int)std::thread::hardware_concurrency();
+        if (workers > (int)fns.size()) workers = (int)fns.size();
+        std::vector<std::thread> pool;
+        for (int t = 1; t < workers; ++t) pool.emplace_back(worker);
+        worker();
+        for (auto& th : pool) th.join();
+
+        for (size_t k = 0; k < errors.size(); ++k) {
+            for (auto* list : {&declErrors[k], &errors[k]}) {
+                for (auto& d : *list) {
+                    if (!diags) throw CompileError(d.message, d.line, d.column);
+                    diags->report(d);
+                }
+            }
         }
     }
-}
 
-private: void checkFunction(std::shared_ptr<FunctionDefNode> fn) { vars.clear(); for (auto& param : fn->params) { vars[param.name] = {param.type, true}; } checkBlock(std::dynamic_pointer_cast<BlockNode>(fn->body), fn->returnType); }
+private:
+    // Nama variabel di-intern sekali per node sebelum pengecekan.
+    void internNames(const std::shared_ptr<FunctionDefNode>& fn) {
+        for (auto& param : fn->params) param.sym = names.intern(param.name);
+        internNames(fn->body);
+    }
 
-void checkBlock(const std::shared_ptr<BlockNode>& block, const std::string& expectedReturnType) {
-    std::unordered_set<std::string> localVars;
+    void internNames(const NodePtr& node) {
+        if (node->kind == NodeKind::VarRef) {
+            auto v = std::static_pointer_cast<VarRefNode>(node);
+            v->sym = names.intern(v->name);
+        } else if (node->kind == NodeKind::Decl) {
+            auto d = std::static_pointer_cast<DeclStmtNode>(node);
+            d->sym = names.intern(d->name);
+        }
+        visitChildren(node, [this](const NodePtr& c) { internNames(c); });
+    }
 
-    for (auto& stmt : block->statements) {
-        if (auto decl = std::dynamic_pointer_cast<DeclStmtNode>(stmt)) {
-            if (localVars.count(decl->name)) {
-                throw std::runtime_error("Redefinition of variable '" + decl->name + "' at line " + std::to_string(decl->line));
+    // Nama tipe yang dipakai tapi tidak pernah didefinisikan tetap Named.
+    // Alias tidak dibuka: tipe tujuannya diperiksa di definisi alias.
+    // Mengembalikan false (dan mencatat error) bila tipenya tidak dikenal.
+    bool checkKnown(std::vector<Diagnostic>& errors, TypeId type, int line, int column) const {
+        while (type != NoType) {
+            const TypeInfo& t = types.info(type);
+            if (t.kind == TypeKind::Named) {
+                errors.push_back({line, column, "unknown type '" + t.name + "'"});
+                return false;
             }
-            localVars.insert(decl->name);
+            if (t.kind != TypeKind::Pointer && t.kind != TypeKind::Slice && t.kind != TypeKind::Array) break;
+            type = t.elem;
         }
-        checkStmt(stmt, expectedReturnType);
+        return true;
+    }
+
+    bool isKnown(TypeId type) const {
+        std::vector<Diagnostic> ignored;
+        return checkKnown(ignored, type, 0, 0);
+    }
+
+    [[noreturn]] static void error(const Node& at, const std::string& msg) {
+        throw CompileError(msg, at.line, at.column);
+    }
+
+    // Catat error lalu lanjut ke statement/ekspresi berikutnya.
+    template<typename F>
+    void recover(FunctionScope& fs, F&& f) const {
+        try {
+            f();
+        } catch (const CompileError& e) {
+            fs.errors.push_back({e.line, e.column, e.message});
+        }
+    }
+
+    // Literal integer menyesuaikan dengan tipe integer tujuan (mis. register u32);
+    // untuk tipe vektor literal diisikan ke semua lane.
+    bool assignable(TypeId target, TypeId actual, const NodePtr& expr) const {
+        if (types.same(target, actual)) return true;
+        auto lit = std::dynamic_pointer_cast<LiteralNode>(expr);
+        return lit && isdigit(lit->value[0]) && (types.isInteger(target) || types.isVector(target));
+    }
+
+    const std::string& typeName(TypeId t) const { return types.name(t); }
+
+    void checkFunction(FunctionScope& fs, const std::shared_ptr<FunctionDefNode>& fn) const {
+        fs.scopes.reset(names.size());
+        fs.nextLocal = 0;
+        fs.scopes.pushScope();
+        for (auto& param : fn->params) {
+            param.local = fs.nextLocal++;
+            if (!fs.scopes.declare(param.sym, {param.type, param.local})) {
+                fs.errors.push_back({param.line, param.column, "duplicate parameter '" + param.name + "' in function " + fn->name});
+            }
+        }
+        checkBlock(fs, std::dynamic_pointer_cast<BlockNode>(fn->body), fn->returnType);
+        fs.scopes.popScope();
+        fn->localCount = fs.nextLocal;
+    }
+
+    void checkBlock(FunctionScope& fs, const std::shared_ptr<BlockNode>& block, TypeId expectedReturnType) const {
+        fs.scopes.pushScope();
+        for (auto& stmt : block->statements) {
+            recover(fs, [&] { checkStmt(fs, stmt, expectedReturnType); });
+        }
+        fs.scopes.popScope();
     }
-}
 
-void checkStmt(const NodePtr& stmt, const std::string& expectedReturnType) {
+void checkStmt(FunctionScope& fs, const NodePtr& stmt, TypeId expectedReturnType) const {
     switch (stmt->kind) {
         case NodeKind::Decl: {
             auto d = std::dynamic_pointer_cast<DeclStmtNode>(stmt);
-            std::string actualType = checkExpr(d->expr);
-            if (!d->type.empty() && d->type != actualType) {
-                throw std::runtime_error("Type mismatch in declaration of " + d->name);
+            TypeId actualType = NoType;
+            // expr kosong: nilai awalnya gagal di-parse dan sudah dilaporkan.
+            if (d->expr) recover(fs, [&] { actualType = checkExpr(fs, d->expr); });
+            // Tetap dideklarasikan walau ekspresinya salah, agar pemakaian berikutnya tidak ikut error.
+            bool known = checkKnown(fs.errors, d->type, d->line, d->column);
+            d->local = fs.nextLocal++;
+            if (!fs.scopes.declare(d->sym, {d->type, d->local})) {
+                error(*d, "redefinition of variable '" + d->name + "'");
+            }
+            if (actualType == NoType || !known) break;
+            TypeId declElem = types.element(d->type);
+            if (d->expr->kind == NodeKind::ArrayLiteral && declElem != NoType && !types.isPointer(d->type)) {
+                for (auto& el : std::static_pointer_cast<ArrayLiteralNode>(d->expr)->elements) {
+                    if (!assignable(declElem, el->resolvedType, el)) {
+                        error(*el, "type mismatch in declaration of '" + d->name + "': expected " + typeName(declElem) + " element, found " + typeName(el->resolvedType));
+                    }
+                }
+            } else if (!assignable(d->type, actualType, d->expr)) {
+                error(*d, "type mismatch in declaration of '" + d->name + "': expected " + typeName(d->type) + ", found " + typeName(actualType));
             }
-            vars[d->name] = {d->type.empty() ? actualType : d->type, true};
             break;
         }
         case NodeKind::Assign: {
             auto a = std::dynamic_pointer_cast<AssignStmtNode>(stmt);
-            std::string rhsType = checkExpr(a->expr);
-            if (a->lhs->kind == NodeKind::VarRef) {
+            TypeId rhsType = checkExpr(fs, a->expr);
+            if (a->lhs->kind == NodeKind::MemberAccess || a->lhs->kind == NodeKind::ArrayIndex) {
+                TypeId lhsType = checkExpr(fs, a->lhs);
+                if (a->expr->kind != NodeKind::ArrayLiteral && !assignable(lhsType, rhsType, a->expr)) {
+                    error(*a->lhs, "type mismatch in assignment: expected " + typeName(lhsType) + ", found " + typeName(rhsType));
+                }
+            } else if (a->lhs->kind == NodeKind::VarRef) {
                 auto v = std::dynamic_pointer_cast<VarRefNode>(a->lhs);
-                if (!vars.count(v->name)) {
-                    throw std::runtime_error("Undefined variable: " + v->name);
+                TypeId lhsType = checkExpr(fs, v);
+                if (v->local < 0) {
+                    error(*v, "cannot assign to '" + v->name + "'");
                 }
-                if (vars[v->name].type != rhsType) {
-                    throw std::runtime_error("Type mismatch in assignment to " + v->name);
+                if (!assignable(lhsType, rhsType, a->expr)) {
+                    error(*v, "type mismatch in assignment to '" + v->name + "': expected " + typeName(lhsType) + ", found " + typeName(rhsType));
                 }
             }
             break;
         }
         case NodeKind::PointerAssign: {
             auto p = std::dynamic_pointer_cast<PointerAssignNode>(stmt);
-            std::string ptrType = checkExpr(p->pointerExpr);
-            std::string valType = checkExpr(p->valueExpr);
-            if (ptrType.find('*') != 0) {
-                throw std::runtime_error("Pointer assignment must assign to a pointer at line " + std::to_string(p->line));
+            TypeId ptrType = checkExpr(fs, p->pointerExpr);
+            TypeId valType = checkExpr(fs, p->valueExpr);
+            if (!types.isPointer(ptrType)) {
+                error(*p, "pointer assignment must assign to a pointer");
             }
-            if (ptrType.substr(1) != valType) {
-                throw std::runtime_error("Type mismatch in pointer assignment at line " + std::to_string(p->line));
+            TypeId target = types.element(ptrType);
+            if (!assignable(target, valType, p->valueExpr)) {
+                error(*p, "type mismatch in pointer assignment: expected " + typeName(target) + ", found " + typeName(valType));
             }
             break;
         }
         case NodeKind::ExprStmt: {
-            checkExpr(std::dynamic_pointer_cast<ExprStmtNode>(stmt)->expr);
+            checkExpr(fs, std::dynamic_pointer_cast<ExprStmtNode>(stmt)->expr);
             break;
         }
         case NodeKind::Return: {
             auto r = std::dynamic_pointer_cast<ReturnStmtNode>(stmt);
             if (r->expr) {
-                std::string retType = checkExpr(r->expr);
-                if (expectedReturnType != retType) {
-                    throw std::runtime_error("Return type mismatch");
+                TypeId retType = checkExpr(fs, r->expr);
+                // Tipe return yang tidak dikenal sudah dilaporkan di signature.
+                if (isKnown(expectedReturnType) && !assignable(expectedReturnType, retType, r->expr)) {
+                    error(*r, "return type mismatch: expected " + typeName(expectedReturnType) + ", found " + typeName(retType));
                 }
             }
             break;
@@ -90,24 +269,28 @@ void checkStmt(const NodePtr& stmt, const std::string& expectedReturnType) {
         case NodeKind::If: {
             auto i = std::dynamic_pointer_cast<IfStmtNode>(stmt);
             for (auto& [cond, blk] : i->branches) {
-                std::string condType = checkExpr(cond);
-                if (condType != "bool") {
-                    throw std::runtime_error("If condition must be bool");
-                }
-                checkBlock(std::dynamic_pointer_cast<BlockNode>(blk), expectedReturnType);
+                recover(fs, [&] {
+                    TypeId condType = checkExpr(fs, cond);
+                    if (!types.same(condType, types.Bool)) {
+                        error(*cond, "if condition must be bool, found " + typeName(condType));
+                    }
+                });
+                checkBlock(fs, std::dynamic_pointer_cast<BlockNode>(blk), expectedReturnType);
             }
             if (i->elseBlock) {
-                checkBlock(std::dynamic_pointer_cast<BlockNode>(i->elseBlock), expectedReturnType);
+                checkBlock(fs, std::dynamic_pointer_cast<BlockNode>(i->elseBlock), expectedReturnType);
             }
             break;
         }
         case NodeKind::While: {
             auto w = std::dynamic_pointer_cast<WhileStmtNode>(stmt);
-            std::string condType = checkExpr(w->cond);
-            if (condType != "bool") {
-                throw std::runtime_error("While condition must be bool");
-            }
-            checkBlock(std::dynamic_pointer_cast<BlockNode>(w->block), expectedReturnType);
+            recover(fs, [&] {
+                TypeId condType = checkExpr(fs, w->cond);
+                if (!types.same(condType, types.Bool)) {
+                    error(*w->cond, "while condition must be bool, found " + typeName(condType));
+                }
+            });
+            checkBlock(fs, std::dynamic_pointer_cast<BlockNode>(w->block), expectedReturnType);
             break;
         }
         case NodeKind::Break:
@@ -117,7 +300,7 @@ void checkStmt(const NodePtr& stmt, const std::string& expectedReturnType) {
         case NodeKind::Inj: {
             auto inj = std::dynamic_pointer_cast<InjStmtNode>(stmt);
             for (const auto& val : inj->values) {
-                checkExpr(val);
+                checkExpr(fs, val);
             }
             break;
         }
@@ -126,45 +309,206 @@ void checkStmt(const NodePtr& stmt, const std::string& expectedReturnType) {
     }
 }
 
-std::string checkExpr(const NodePtr& expr) {
+// Tipe hasil disimpan di node agar codegen tidak menurunkannya ulang.
+TypeId checkExpr(FunctionScope& fs, const NodePtr& expr) const {
+    TypeId type = inferExpr(fs, expr);
+    expr->resolvedType = type;
+    return type;
+}
+
+TypeId inferExpr(FunctionScope& fs, const NodePtr& expr) const {
     switch (expr->kind) {
         case NodeKind::Literal: {
             auto lit = std::dynamic_pointer_cast<LiteralNode>(expr);
-            if (lit->value == "true" || lit->value == "false") return "bool";
-            if (isdigit(lit->value[0])) return "u16";
-            return "str";
+            if (lit->value == "true" || lit->value == "false") return types.Bool;
+            if (isdigit(lit->value[0])) return types.U16;
+            return types.Str;
         }
         case NodeKind::VarRef: {
             auto v = std::dynamic_pointer_cast<VarRefNode>(expr);
-            if (!vars.count(v->name)) throw std::runtime_error("Undefined variable: " + v->name);
-            return vars[v->name].type;
+            const VarInfo* info = fs.scopes.lookup(v->sym);
+            if (!info) {
+                // Struct at(alamat) dipakai langsung sebagai blok register.
+                auto mmio = mmioStructs.find(v->name);
+                if (mmio != mmioStructs.end()) {
+                    v->isVolatile = true;
+                    return mmio->second;
+                }
+                error(*v, "undefined variable '" + v->name + "'");
+            }
+            v->local = info->local;
+            return info->type;
         }
         case NodeKind::Call: {
             auto c = std::dynamic_pointer_cast<CallNode>(expr);
-            if (!functions.count(c->name)) throw std::runtime_error("Undefined function: " + c->name);
-            return functions[c->name];
+            if (!functions.count(c->name) && isIntrinsic(c->name)) return checkIntrinsic(fs, c);
+            if (!functions.count(c->name)) error(*c, "undefined function '" + c->name + "'");
+            for (auto& arg : c->args) checkExpr(fs, arg);
+            return functions.at(c->name);
         }
         case NodeKind::BinaryOp: {
             auto b = std::dynamic_pointer_cast<BinaryOpNode>(expr);
-            std::string lhs = checkExpr(b->lhs);
-            std::string rhs = checkExpr(b->rhs);
-            if (lhs != rhs) throw std::runtime_error("Binary op type mismatch");
-            if (b->op == "==" || b->op == "!=" || b->op == "<" || b->op == ">") return "bool";
+            TypeId lhs = checkExpr(fs, b->lhs);
+            TypeId rhs = checkExpr(fs, b->rhs);
+            if (b->op == "and" || b->op == "or") return types.Bool;
+            if (!types.same(lhs, rhs)) {
+                if (assignable(lhs, rhs, b->rhs)) rhs = lhs;
+                else if (assignable(rhs, lhs, b->lhs)) lhs = rhs;
+                else error(*b, "operands of '" + b->op + "' differ in type: " + typeName(lhs) + " and " + typeName(rhs));
+            }
+            if (types.isVector(lhs) && b->op != "+" && b->op != "-" && b->op != "*") {
+                error(*b, "operator '" + b->op + "' is not defined on " + typeName(lhs));
+            }
+            if (b->op == "==" || b->op == "!=" || b->op == "<" || b->op == ">" || b->op == "<=" || b->op == ">=") return types.Bool;
             return lhs;
         }
         case NodeKind::UnaryOp: {
             auto u = std::dynamic_pointer_cast<UnaryOpNode>(expr);
-            return checkExpr(u->rhs);
+            TypeId t = checkExpr(fs, u->rhs);
+            if (types.isVector(t) && u->op != "&") {
+                error(*u, "operator '" + u->op + "' is not defined on " + typeName(t));
+            }
+            if (u->op == "*" && types.isPointer(t)) return types.element(t);
+            if (u->op == "&") return types.pointerTo(t);
+            if (u->op == "!") return types.Bool;
+            return t;
         }
         case NodeKind::StructInit: {
             auto s = std::dynamic_pointer_cast<StructInitNode>(expr);
-            if (!structFields.count(s->name)) {
-                throw std::runtime_error("Undefined struct: " + s->name + " at line " + std::to_string(s->line));
+            auto it = structsByName.find(s->name);
+            if (it == structsByName.end()) {
+                error(*s, "undefined struct '" + s->name + "'");
+            }
+            for (auto& arg : s->args) checkExpr(fs, arg);
+            return it->second;
+        }
+        case NodeKind::MemberAccess: {
+            auto m = std::dynamic_pointer_cast<MemberAccessNode>(expr);
+            TypeId objType = checkExpr(fs, m->object);
+            m->isVolatile = m->object->isVolatile;
+            if (types.isPointer(objType)) objType = types.element(objType);
+            auto it = structFields.find(types.canonical(objType));
+            if (it == structFields.end()) {
+                error(*m, "member access on non-struct type '" + typeName(objType) + "'");
+            }
+            auto field = it->second.find(m->field);
+            if (field == it->second.end()) {
+                error(*m, "struct '" + typeName(objType) + "' has no field '" + m->field + "'");
+            }
+            return field->second;
+        }
+        case NodeKind::ArrayIndex: {
+            auto ai = std::dynamic_pointer_cast<ArrayIndexNode>(expr);
+            TypeId arrType = checkExpr(fs, ai->array);
+            checkExpr(fs, ai->index);
+            ai->isVolatile = ai->array->isVolatile;
+            TypeId elem = types.element(arrType);
+            if (elem == NoType) {
+                error(*ai, "indexing non-array type '" + typeName(arrType) + "'");
+            }
+            return elem;
+        }
+        case NodeKind::ArrayLiteral: {
+            auto arr = std::dynamic_pointer_cast<ArrayLiteralNode>(expr);
+            TypeId elem = NoType;
+            for (auto& el : arr->elements) {
+                TypeId t = checkExpr(fs, el);
+                if (elem != NoType && !types.same(t, elem)) {
+                    error(*el, "array literal elements differ in type: " + typeName(elem) + " and " + typeName(t));
+                }
+                elem = t;
             }
-            return s->name;
+            return elem == NoType ? NoType : types.sliceOf(elem);
+        }
+        default: return types.U16;
+    }
+}
+
+// Intrinsik vektor; fungsi buatan pengguna dengan nama yang sama didahulukan.
+//   vload(a, i) / vstore(a, i, v): lane a[i..] dari array, slice atau pointer u8/u16/u32
+//   vsplat(x): x di semua lane; vsum(v): jumlah lane sebagai u64
+//   vmin(a, b) / vmax(a, b): minimum/maksimum per lane
+//   atomic_load(p, o), atomic_store(p, v, o), atomic_add(p, v, o) -> nilai lama,
+//   atomic_cas(p, expected, desired, o) -> nilai lama, atomic_fence(o)
+static bool isIntrinsic(const std::string& name) {
+    return name == "vload" || name == "vstore" || name == "vsplat" || name == "vsum" || name == "vmin" || name == "vmax" ||
+           name == "atomic_load" || name == "atomic_store" || name == "atomic_add" || name == "atomic_cas" ||
+           name == "atomic_fence";
+}
+
+TypeId checkIntrinsic(FunctionScope& fs, const std::shared_ptr<CallNode>& c) const {
+    if (c->name.rfind("atomic_", 0) == 0) return checkAtomic(fs, c);
+    size_t arity = c->name == "vstore" ? 3 : c->name == "vsplat" || c->name == "vsum" ? 1 : 2;
+    std::vector<TypeId> args;
+    for (auto& arg : c->args) args.push_back(checkExpr(fs, arg));
+    if (args.size() != arity) {
+        error(*c, c->name + " expects " + std::to_string(arity) + " argument(s), found " + std::to_string(args.size()));
+    }
+    c->builtin = true;
+
+    if (c->name == "vload" || c->name == "vstore") {
+        TypeId vec = types.vectorOf(types.element(args[0]));
+        if (vec == NoType) {
+            error(*c->args[0], c->name + " expects an array, slice or pointer of u8, u16 or u32, found " + typeName(args[0]));
+        }
+        if (!types.isInteger(args[1])) error(*c->args[1], "vector index must be an integer, found " + typeName(args[1]));
+        if (c->name == "vload") return vec;
+        if (!assignable(vec, args[2], c->args[2])) {
+            error(*c->args[2], "vstore expects " + typeName(vec) + ", found " + typeName(args[2]));
+        }
+        return types.Void;
+    }
+    if (c->name == "vsplat") {
+        TypeId vec = types.vectorOf(args[0]);
+        if (vec == NoType) error(*c->args[0], "vsplat expects u8, u16 or u32, found " + typeName(args[0]));
+        return vec;
+    }
+    if (c->name == "vsum") {
+        if (!types.isVector(args[0])) error(*c->args[0], "vsum expects a vector, found " + typeName(args[0]));
+        return types.U64;
+    }
+    TypeId vec = types.isVector(args[0]) ? args[0] : args[1];
+    if (!types.isVector(vec)) error(*c, c->name + " expects vectors, found " + typeName(args[0]) + " and " + typeName(args[1]));
+    for (size_t i = 0; i < 2; ++i) {
+        if (!assignable(vec, args[i], c->args[i])) {
+            error(*c->args[i], "operands of " + c->name + " differ in type: " + typeName(args[0]) + " and " + typeName(args[1]));
+        }
+    }
+    return vec;
+}
+
+// Argumen terakhir atomik adalah nama urutan memori, bukan variabel.
+TypeId checkAtomic(FunctionScope& fs, const std::shared_ptr<CallNode>& c) const {
+    size_t arity = c->name == "atomic_fence" ? 1 : c->name == "atomic_load" ? 2 : c->name == "atomic_cas" ? 4 : 3;
+    if (c->args.size() != arity) {
+        error(*c, c->name + " expects " + std::to_string(arity) + " argument(s), found " + std::to_string(c->args.size()));
+    }
+    c->builtin = true;
+    auto order = std::dynamic_pointer_cast<VarRefNode>(c->args.back());
+    if (!order || (order->name != "relaxed" && order->name != "acquire" && order->name != "release" &&
+                   order->name != "acq_rel" && order->name != "seq_cst")) {
+        error(*c->args.back(), c->name + " expects a memory order (relaxed, acquire, release, acq_rel or seq_cst) as last argument");
+    }
+    c->order = order->name;
+    bool releases = c->order == "release" || c->order == "acq_rel";
+    bool acquires = c->order == "acquire" || c->order == "acq_rel";
+    if ((c->name == "atomic_load" && releases) || (c->name == "atomic_store" && acquires)) {
+        error(*order, "memory order '" + c->order + "' is not valid for " + c->name);
+    }
+    if (c->name == "atomic_fence") return types.Void;
+
+    TypeId ptr = checkExpr(fs, c->args[0]);
+    TypeId elem = types.element(ptr);
+    if (!types.isPointer(ptr) || !types.isInteger(elem) || types.isSigned(elem)) {
+        error(*c->args[0], c->name + " expects a pointer to an unsigned integer, found " + typeName(ptr));
+    }
+    for (size_t i = 1; i + 1 < arity; ++i) {
+        TypeId t = checkExpr(fs, c->args[i]);
+        if (!assignable(elem, t, c->args[i])) {
+            error(*c->args[i], c->name + " expects " + typeName(elem) + ", found " + typeName(t));
         }
-        default: return "u16";
     }
+    return c->name == "atomic_store" ? types.Void : elem;
 }
 
 };
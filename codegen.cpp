@@ -1,37 +1,87 @@
 #include "ast.hpp"
-#include <sstream>
+#include "layout.hpp"
+#include "rodata.hpp"
+#include "asmsink.hpp"
+#include "fncache.hpp"
+#include "diagnostics.hpp"
+#include "cse.hpp"
+#include "sra.hpp"
 #include <vector>
 #include <string>
 #include <stack>
 #include <unordered_map>
+#include <unordered_set>
+#include <set>
 #include <memory>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <functional>
 
-struct StructLayout {
-    std::unordered_map<std::string, int> fieldOffsets;
-    int size = 0;
+// Operand memori AArch64: [base, #offset] atau [base, index, lsl #shift].
+struct AddrMode {
+    std::string base = "x0";
+    std::string index;
+    int shift = 0;
+    int offset = 0;
+
+    std::string str() const {
+        if (!index.empty()) return "[" + base + ", " + index + (shift ? ", lsl #" + std::to_string(shift) : "") + "]";
+        if (offset) return "[" + base + ", #" + std::to_string(offset) + "]";
+        return "[" + base + "]";
+    }
 };
 
 class CodegenASM {
-    std::vector<std::string> asmLines;
-    int labelCount = 0;
+    std::string asmText; // teks fungsi yang sedang dibuat
+    int labelCount = 0; // per fungsi; label diberi awalan nama fungsi
+    std::string functionName;
+    int jobs;
     std::stack<std::string> breakLabels;
     std::stack<std::string> continueLabels;
-    std::unordered_map<std::string, StructLayout> structLayouts;
-    std::unordered_map<std::string, int> localOffsets;
-    int currentOffset = 0;
+    LayoutEngine& layouts;
+    TypeTable& types;
+    // Lokal dikunci dengan id binding dari checker, jadi shadowing aman.
+    std::unordered_map<int, int> localOffsets;
+    std::unordered_map<int, std::string> localRegs; // fungsi leaf: lokal tinggal di register
+    std::unordered_set<int> inlineLocals; // agregat yang disimpan langsung di frame
+    int frameTop = 0;  // byte frame di bawah x29 yang sedang terpakai
+    int frameSize = 0; // maksimum frameTop; di-patch ke prolog setelah body selesai
+    int lastTemp = 0;  // offset temporer agregat terakhir (StructInit/ArrayLiteral)
+    size_t framePos = 0; // posisi sub sp di asmText, diisi setelah body
+    std::unordered_set<int> addressTaken;
+    bool leafFrame = false;  // tanpa prolog/epilog
+    bool tailCalls = false;  // return f(...) boleh jadi b f
+    std::unordered_map<int, TypeId> localTypes;
+    std::unordered_map<std::string, TypeId> functionTypes;
+    int spDepth = 0; // byte yang sedang di-push/dialokasikan di bawah sp
+    std::string epilogueLabel;
+    std::vector<std::pair<TypeId, std::string>> mmioRegs; // struct at() -> register basis
+    RodataPool rodata;
+    FunctionCache* cache = nullptr;
+    bool lse = false; // target punya atomik LSE (ARMv8.1): ldadd/cas tanpa loop
+    std::unordered_set<int> writtenLocals;
+    int functionCse = 0; // ekspresi yang dihapus CSE di fungsi terakhir
+    int functionSra = 0; // lokal struct yang dipecah di fungsi terakhir
+    std::vector<Diagnostic> remarks; // catatan optimasi fungsi terakhir (--opt-report)
 
-    std::unordered_map<std::string, std::string> localStringLiterals;
+    std::unordered_map<int, std::string> localStringLiterals;
 
     std::string uniqueLabel(const std::string& base) {
-        return base + std::to_string(labelCount++);
+        return ".L" + functionName + "_" + base + std::to_string(labelCount++);
     }
 
     void emit(const std::string& line) {
-        asmLines.push_back(line);
+        asmText += line;
+        asmText += '\n';
     }
 
     void emitLabel(const std::string& label) {
-        asmLines.push_back(label + ":");
+        asmText += label;
+        asmText += ":\n";
     }
 
     std::string evalStringExpr(const NodePtr& node) {
@@ -39,8 +89,8 @@ class CodegenASM {
             return lit->value;
         }
         if (auto var = std::dynamic_pointer_cast<VarRefNode>(node)) {
-            if (localStringLiterals.count(var->name))
-                return localStringLiterals[var->name];
+            if (localStringLiterals.count(var->local))
+                return localStringLiterals[var->local];
             return "<undef:" + var->name + ">";
         }
         if (auto bin = std::dynamic_pointer_cast<BinaryOpNode>(node)) {
@@ -52,8 +102,53 @@ class CodegenASM {
     }
 
 public:
+    // Statistik optimasi fungsi yang dikompilasi ulang (bukan dari cache).
+    struct OptStats {
+        int cseEliminated = 0;
+        int cseFunctions = 0;
+        int sraStructs = 0;
+        std::vector<Diagnostic> remarks; // urut sumber
+    } stats;
+
+    // jobs = 0 memakai semua core.
+    CodegenASM(LayoutEngine& l, int jobs = 1) : jobs(jobs), layouts(l), types(l.typeTable()) {}
+
+    // Pakai ulang assembly fungsi yang sidik jarinya tidak berubah.
+    void setCache(FunctionCache* c) { cache = c; }
+
+    // Fitur target yang memengaruhi pemilihan instruksi.
+    void setLse(bool on) { lse = on; }
+
     std::string generate(std::shared_ptr<ProgramNode> program) {
-        asmLines.clear();
+        StringSink out;
+        generate(program, out);
+        return out.str();
+    }
+
+    // Teks tiap fungsi ditulis ke sink segera setelah fungsi itu (dan semua
+    // fungsi sebelumnya) selesai, lalu buffernya dibuang.
+    void generate(std::shared_ptr<ProgramNode> program, AsmSink& out) {
+        asmText.clear();
+        functionTypes.clear();
+        rodata.clear();
+        stats = OptStats();
+        std::vector<std::shared_ptr<FunctionDefNode>> fns;
+        std::unordered_map<std::string, std::shared_ptr<FunctionDefNode>> byName;
+        for (auto& node : program->topDefs) {
+            if (node->kind == NodeKind::FunctionDef) {
+                auto fn = std::dynamic_pointer_cast<FunctionDefNode>(node);
+                functionTypes[fn->name] = fn->returnType;
+                fns.push_back(fn);
+                byName[fn->name] = fn;
+            }
+        }
+        std::vector<uint64_t> fingerprints;
+        if (cache) {
+            cache->begin();
+            FunctionFingerprint fingerprint(layouts, byName, lse ? "+lse" : "");
+            for (auto& fn : fns) fingerprints.push_back(fingerprint.of(fn));
+        }
+
         emit(".text");
         emit(".global _start");
         emit("_start:");
@@ -61,58 +156,1918 @@ public:
         emit("  mov x8, #93");
         emit("  mov x0, #0");
         emit("  svc #0");
+        out.write(asmText);
+        asmText.clear();
+
+        // Tiap fungsi punya buffer, label lokal dan pool .rodata sendiri; hasilnya
+        // ditulis menurut urutan sumber sehingga identik dengan mode serial.
+        struct FunctionOutput {
+            std::string text;
+            RodataPool rodata;
+            std::exception_ptr error;
+            int cse = 0;
+            int sra = 0;
+            std::vector<Diagnostic> remarks;
+            bool reused = false;
+            bool done = false;
+        };
+        std::vector<FunctionOutput> outputs(fns.size());
+        std::atomic<size_t> next{0};
+        std::mutex doneMutex;
+        std::condition_variable doneCv;
+        auto genOne = [&](CodegenASM& fc, size_t i) {
+            if (cache) {
+                if (auto hit = cache->find(fns[i]->name, fingerprints[i])) {
+                    // Catatan dan hitungan optimasi diputar ulang seperti saat
+                    // fungsi ini dikompilasi; baris digeser ke posisinya sekarang.
+                    outputs[i].text = hit->text;
+                    outputs[i].rodata.merge(hit->rodata);
+                    outputs[i].cse = hit->cse;
+                    outputs[i].sra = hit->sra;
+                    outputs[i].remarks = hit->remarks;
+                    for (auto& r : outputs[i].remarks) r.line += fns[i]->line;
+                    outputs[i].reused = true;
+                    return;
+                }
+            }
+            fc.asmText.clear();
+            fc.rodata.clear();
+            try {
+                fc.genFunction(fns[i]);
+                outputs[i].text = std::move(fc.asmText);
+                outputs[i].rodata = std::move(fc.rodata);
+                outputs[i].cse = fc.functionCse;
+                outputs[i].sra = fc.functionSra;
+                outputs[i].remarks = std::move(fc.remarks);
+            } catch (...) {
+                outputs[i].error = std::current_exception();
+            }
+        };
+        auto finish = [&](size_t i) {
+            FunctionOutput& o = outputs[i];
+            if (o.error) std::rethrow_exception(o.error);
+            if (cache) {
+                FunctionCache::Entry e{fingerprints[i], o.text, o.rodata, o.cse, o.sra, o.remarks};
+                for (auto& r : e.remarks) r.line -= fns[i]->line;
+                cache->store(fns[i]->name, std::move(e));
+                ++(o.reused ? cache->reused : cache->compiled);
+            }
+            // Label pool fungsi bisa berbeda dari pool gabungan bila hash bertabrakan.
+            out.write(RodataPool::relabel(o.text, rodata.merge(o.rodata)));
+            if (o.cse) {
+                stats.cseEliminated += o.cse;
+                ++stats.cseFunctions;
+            }
+            stats.sraStructs += o.sra;
+            stats.remarks.insert(stats.remarks.end(), o.remarks.begin(), o.remarks.end());
+            o = FunctionOutput();
+        };
 
-        for (auto& node : program->topDefs) gen(node);
+        int workers = jobs > 0 ? jobs : (int)std::thread::hardware_concurrency();
+        if (workers > (int)fns.size()) workers = (int)fns.size();
+        if (workers <= 1) {
+            CodegenASM fc(layouts);
+            fc.functionTypes = functionTypes;
+            fc.lse = lse;
+            for (size_t i = 0; i < fns.size(); ++i) {
+                genOne(fc, i);
+                finish(i);
+            }
+        } else {
+            const size_t window = 2 * (size_t)workers;
+            size_t written = 0;
+            bool stopped = false;
+            std::vector<std::thread> pool;
+            for (int t = 0; t < workers; ++t) {
+                pool.emplace_back([&]() {
+                    CodegenASM fc(layouts);
+                    fc.functionTypes = functionTypes;
+                    fc.lse = lse;
+                    for (size_t i; (i = next.fetch_add(1)) < fns.size();) {
+                        {
+                            // Jangan terlalu jauh mendahului penulis: teks yang
+                            // menunggu giliran tetap dibatasi 2 * workers fungsi.
+                            std::unique_lock<std::mutex> lock(doneMutex);
+                            doneCv.wait(lock, [&] { return stopped || i < written + window; });
+                            if (stopped) break;
+                        }
+                        genOne(fc, i);
+                        std::lock_guard<std::mutex> lock(doneMutex);
+                        outputs[i].done = true;
+                        doneCv.notify_all();
+                    }
+                });
+            }
+            std::exception_ptr error;
+            for (size_t i = 0; i < fns.size(); ++i) {
+                {
+                    std::unique_lock<std::mutex> lock(doneMutex);
+                    doneCv.wait(lock, [&] { return outputs[i].done; });
+                }
+                try {
+                    finish(i);
+                } catch (...) {
+                    // Hentikan antrean, tunggu worker yang masih jalan, baru lempar lagi.
+                    error = std::current_exception();
+                    next = fns.size();
+                    std::lock_guard<std::mutex> lock(doneMutex);
+                    stopped = true;
+                    doneCv.notify_all();
+                    break;
+                }
+                std::lock_guard<std::mutex> lock(doneMutex);
+                written = i + 1;
+                doneCv.notify_all();
+            }
+            for (auto& th : pool) th.join();
+            if (error) std::rethrow_exception(error);
+        }
 
-        std::ostringstream out;
-        for (auto& line : asmLines) out << line << "\n";
-        return out.str();
+        rodata.emit([this](const std::string& line) { emit(line); });
+        out.write(asmText);
+        asmText.clear();
+        out.flush();
+    }
+
+    // Tipe statis ekspresi; diisi SemanticChecker di setiap node ekspresi.
+    TypeId typeOf(const NodePtr& expr) {
+        if (expr->resolvedType != NoType) return expr->resolvedType;
+        if (auto v = std::dynamic_pointer_cast<VarRefNode>(expr)) {
+            return localTypes.count(v->local) ? localTypes[v->local] : NoType;
+        }
+        return NoType;
+    }
+
+    TypeId elementType(TypeId type) {
+        return types.element(type);
+    }
+
+    // Struct, array berukuran tetap dan vektor disimpan inline; nilainya adalah alamatnya.
+    bool isAggregate(TypeId type) {
+        return types.isStruct(type) || types.isArray(type) || types.isVector(type);
+    }
+
+    int strideOf(TypeId elemType) {
+        if (elemType == NoType) return 8;
+        return LayoutEngine::alignUp(layouts.sizeOf(elemType), layouts.alignOf(elemType));
+    }
+
+    const FieldLayout* fieldOf(const std::shared_ptr<MemberAccessNode>& m) {
+        TypeId t = typeOf(m->object);
+        if (types.isPointer(t)) t = types.element(t);
+        if (!types.isStruct(t)) return nullptr;
+        const FieldLayout* f = layouts.layoutOf(t).field(m->field);
+        if (!f) throw std::runtime_error("Struct '" + types.name(t) + "' has no field '" + m->field + "' at line " + std::to_string(m->line));
+        return f;
+    }
+
+    static bool hasCall(const NodePtr& expr) {
+        if (!expr) return false;
+        switch (expr->kind) {
+            case NodeKind::Call: return true;
+            case NodeKind::BinaryOp: {
+                auto b = std::dynamic_pointer_cast<BinaryOpNode>(expr);
+                return hasCall(b->lhs) || hasCall(b->rhs);
+            }
+            case NodeKind::UnaryOp: return hasCall(std::dynamic_pointer_cast<UnaryOpNode>(expr)->rhs);
+            case NodeKind::MemberAccess: return hasCall(std::dynamic_pointer_cast<MemberAccessNode>(expr)->object);
+            case NodeKind::ArrayIndex: {
+                auto ai = std::dynamic_pointer_cast<ArrayIndexNode>(expr);
+                return hasCall(ai->array) || hasCall(ai->index);
+            }
+            case NodeKind::StructInit:
+            case NodeKind::ArrayLiteral: return true; // mengalokasikan stack
+            default: return false;
+        }
+    }
+
+    bool isConstInt(const NodePtr& expr, long long& value) {
+        auto lit = std::dynamic_pointer_cast<LiteralNode>(expr);
+        if (!lit || !isdigit(lit->value[0])) return false;
+        value = std::stoll(lit->value, nullptr, 0);
+        return true;
+    }
+
+    void push(const std::string& reg) { emit("  str " + reg + ", [sp, #-16]!"); spDepth += 16; }
+    void pop(const std::string& reg) { emit("  ldr " + reg + ", [sp], #16"); spDepth -= 16; }
+
+    // Slot frame di [x29 - frameTop, ...); slot dipakai ulang setelah scope-nya
+    // (atau statement untuk temporer) selesai.
+    int allocFrame(int size, int align) {
+        frameTop = LayoutEngine::alignUp(frameTop + std::max(size, 1), std::max(align, 1));
+        frameSize = std::max(frameSize, frameTop);
+        return -frameTop;
+    }
+
+    void emitMovImm(const std::string& reg, uint64_t value) {
+        if (value < 65536) {
+            emit("  mov " + reg + ", #" + std::to_string(value));
+            return;
+        }
+        bool first = true;
+        for (int shift = 0; shift < 64; shift += 16) {
+            uint64_t part = (value >> shift) & 0xffff;
+            if (!part) continue;
+            emit("  " + std::string(first ? "movz " : "movk ") + reg + ", #" + std::to_string(part) + ", lsl #" + std::to_string(shift));
+            first = false;
+        }
+    }
+
+    void emitAddImm(const std::string& dst, const std::string& src, long long imm) {
+        if (imm >= 0 && imm < 4096) {
+            emit("  add " + dst + ", " + src + ", #" + std::to_string(imm));
+        } else if (imm < 0 && imm > -4096) {
+            emit("  sub " + dst + ", " + src + ", #" + std::to_string(-imm));
+        } else {
+            emitMovImm("x16", (uint64_t)imm);
+            emit("  add " + dst + ", " + src + ", x16");
+        }
+    }
+
+    // Pastikan offset muat di mode [base, #imm] untuk akses selebar size.
+    void legalize(AddrMode& a, int size) {
+        if (!a.index.empty() || a.offset == 0) return;
+        bool scaled = a.offset > 0 && a.offset % size == 0 && a.offset / size < 4096;
+        bool unscaled = a.offset >= -256 && a.offset <= 255;
+        if (scaled || unscaled) return;
+        std::string dst = scratchFor(a.base);
+        emitAddImm(dst, a.base, a.offset);
+        a.base = dst;
+        a.offset = 0;
+    }
+
+    // sp, x29 dan register basis MMIO tidak boleh ditimpa perhitungan alamat.
+    static std::string scratchFor(const std::string& base) {
+        return (base == "x0" || base == "x1" || base == "x2" || base == "x3") ? base : "x15";
+    }
+
+    // Satukan base+index+offset ke satu register.
+    std::string materialize(AddrMode& a) {
+        if (!a.index.empty()) {
+            std::string dst = scratchFor(a.base);
+            emit("  add " + dst + ", " + a.base + ", " + a.index + (a.shift ? ", lsl #" + std::to_string(a.shift) : ""));
+            a.base = dst;
+            a.index.clear();
+            a.shift = 0;
+        }
+        if (a.offset) {
+            std::string dst = scratchFor(a.base);
+            emitAddImm(dst, a.base, a.offset);
+            a.base = dst;
+            a.offset = 0;
+        }
+        return a.base;
+    }
+
+    void emitLoad(TypeId type, int reg, AddrMode a) {
+        legalize(a, type == NoType ? 8 : layouts.sizeOf(type));
+        emit(type == NoType ? "  ldr x" + std::to_string(reg) + ", " + a.str() : layouts.loadInstr(type, reg, a.str()));
+    }
+
+    void emitStore(TypeId type, int reg, AddrMode a) {
+        legalize(a, type == NoType ? 8 : layouts.sizeOf(type));
+        emit(type == NoType ? "  str x" + std::to_string(reg) + ", " + a.str() : layouts.storeInstr(type, reg, a.str()));
+    }
+
+    // Salin size byte; blok 16 byte memakai ldp/stp.
+    void emitCopy(const std::string& dst, int dstOff, const std::string& src, int srcOff, int size) {
+        static const char* tails[][3] = { {"8", "ldr x16", "str x16"}, {"4", "ldr w16", "str w16"},
+                                          {"2", "ldrh w16", "strh w16"}, {"1", "ldrb w16", "strb w16"} };
+        bool direct = dstOff >= 0 && srcOff >= 0 && dstOff + size <= 504 && srcOff + size <= 504;
+        if (!direct) {
+            // Offset di luar jangkauan ldp/stp: pakai pointer post-increment.
+            emitAddImm("x14", dst, dstOff);
+            emitAddImm("x15", src, srcOff);
+            for (; size >= 16; size -= 16) {
+                emit("  ldp x16, x17, [x15], #16");
+                emit("  stp x16, x17, [x14], #16");
+            }
+            for (auto& t : tails) {
+                int width = std::stoi(t[0]);
+                for (; size >= width; size -= width) {
+                    emit("  " + std::string(t[1]) + ", [x15], #" + t[0]);
+                    emit("  " + std::string(t[2]) + ", [x14], #" + t[0]);
+                }
+            }
+            return;
+        }
+        int done = 0;
+        for (; size - done >= 16; done += 16) {
+            emit("  ldp x16, x17, [" + src + ", #" + std::to_string(srcOff + done) + "]");
+            emit("  stp x16, x17, [" + dst + ", #" + std::to_string(dstOff + done) + "]");
+        }
+        for (auto& t : tails) {
+            int width = std::stoi(t[0]);
+            for (; size - done >= width; done += width) {
+                emit("  " + std::string(t[1]) + ", [" + src + ", #" + std::to_string(srcOff + done) + "]");
+                emit("  " + std::string(t[2]) + ", [" + dst + ", #" + std::to_string(dstOff + done) + "]");
+            }
+        }
+    }
+
+    bool isMmioRef(const NodePtr& expr) {
+        auto v = std::dynamic_pointer_cast<VarRefNode>(expr);
+        if (!v || v->local >= 0 || !types.isStruct(v->resolvedType)) return false;
+        return layouts.layoutOf(v->resolvedType).baseAddress != 0;
+    }
+
+    // Register yang memegang alamat basis struct at(); kosong jika bukan MMIO.
+    std::string mmioBaseReg(const NodePtr& expr) {
+        if (!isMmioRef(expr)) return "";
+        return mmioBaseReg(expr->resolvedType);
+    }
+
+    std::string mmioBaseReg(TypeId structType) {
+        for (auto& [type, reg] : mmioRegs) if (type == structType) return reg;
+        emitMovImm("x15", layouts.layoutOf(structType).baseAddress); // register basis habis
+        return "x15";
+    }
+
+    void collectMmio(const NodePtr& node) {
+        if (isMmioRef(node)) {
+            bool seen = false;
+            for (auto& entry : mmioRegs) if (entry.first == node->resolvedType) seen = true;
+            if (!seen && mmioRegs.size() < 8) mmioRegs.emplace_back(node->resolvedType, "x" + std::to_string(19 + mmioRegs.size()));
+        }
+        visitChildren(node, [this](const NodePtr& c) { collectMmio(c); });
+    }
+
+    // Alamat awal penyimpanan objek; anggota inline dilipat ke offset.
+    AddrMode genBaseAddress(const NodePtr& object) {
+        std::string mmio = mmioBaseReg(object);
+        if (!mmio.empty()) {
+            AddrMode m;
+            m.base = mmio;
+            return m;
+        }
+        if (object->kind == NodeKind::StructInit && genConstLiteral(object, typeOf(object))) return AddrMode{};
+        if ((object->kind == NodeKind::MemberAccess || object->kind == NodeKind::ArrayIndex) && isAggregate(typeOf(object))) {
+            TypeId ignored;
+            return genAddress(object, ignored);
+        }
+        genExpr(object);
+        return AddrMode{};
+    }
+
+    void addOffset(AddrMode& a, long long off) {
+        if (!a.index.empty()) materialize(a);
+        a.offset += (int)off;
+    }
+
+    // Apakah alamat penyimpanan expr = pointer lokal (atau basis MMIO) + offset konstan?
+    bool localBase(const NodePtr& expr, std::shared_ptr<VarRefNode>& root, long long& offset) {
+        if (auto v = std::dynamic_pointer_cast<VarRefNode>(expr)) {
+            if (!hasLocal(v->local) && !isMmioRef(expr)) return false;
+            root = v;
+            return true;
+        }
+        if (auto m = std::dynamic_pointer_cast<MemberAccessNode>(expr)) {
+            const FieldLayout* f = fieldOf(m);
+            if (!f || !isAggregate(typeOf(m->object)) || !localBase(m->object, root, offset)) return false;
+            offset += f->offset;
+            return true;
+        }
+        if (auto ai = std::dynamic_pointer_cast<ArrayIndexNode>(expr)) {
+            long long k;
+            if (!isConstInt(ai->index, k) || !isAggregate(typeOf(ai->array)) || !localBase(ai->array, root, offset)) return false;
+            offset += k * strideOf(elementType(typeOf(ai->array)));
+            return true;
+        }
+        return false;
+    }
+
+    AddrMode genAddress(const NodePtr& expr, TypeId& elemType) {
+        if (expr->kind == NodeKind::MemberAccess) {
+            auto m = std::dynamic_pointer_cast<MemberAccessNode>(expr);
+            const FieldLayout* f = fieldOf(m);
+            if (!f) throw std::runtime_error("Member access on non-struct value at line " + std::to_string(m->line));
+            AddrMode a = genBaseAddress(m->object);
+            addOffset(a, f->offset);
+            elemType = f->type;
+            return a;
+        }
+        if (expr->kind == NodeKind::ArrayIndex) {
+            auto ai = std::dynamic_pointer_cast<ArrayIndexNode>(expr);
+            elemType = elementType(typeOf(ai->array));
+            int stride = strideOf(elemType);
+
+            long long k;
+            if (isConstInt(ai->index, k)) {
+                AddrMode a = genBaseAddress(ai->array);
+                addOffset(a, k * stride);
+                return a;
+            }
+
+            AddrMode a;
+            a.base = "x1";
+            std::shared_ptr<VarRefNode> root;
+            long long rootOff = 0;
+            if (localBase(ai->array, root, rootOff)) {
+                // Base cukup satu ldr dari frame: hitung index dulu, tanpa spill.
+                genExpr(ai->index);
+                if (hasLocal(root->local)) {
+                    loadLocal("x1", root->local);
+                    if (rootOff) emitAddImm("x1", "x1", rootOff);
+                } else if (rootOff) {
+                    emitAddImm("x1", mmioBaseReg(root->resolvedType), rootOff);
+                } else {
+                    a.base = mmioBaseReg(root->resolvedType);
+                }
+            } else {
+                AddrMode base = genBaseAddress(ai->array);
+                std::string reg = materialize(base);
+                push(reg);
+                genExpr(ai->index);
+                pop("x1");
+            }
+            if (stride == 1 || stride == 2 || stride == 4 || stride == 8) {
+                a.index = "x0";
+                a.shift = stride == 8 ? 3 : stride == 4 ? 2 : stride == 2 ? 1 : 0;
+            } else {
+                emitMovImm("x2", stride);
+                emit("  madd x1, x0, x2, " + a.base);
+                a.base = "x1";
+            }
+            return a;
+        }
+        throw std::runtime_error("Expression is not addressable at line " + std::to_string(expr->line));
+    }
+
+    bool isSimple(const NodePtr& expr) {
+        if (auto lit = std::dynamic_pointer_cast<LiteralNode>(expr)) return lit->value == "true" || lit->value == "false" || isdigit(lit->value[0]);
+        if (auto v = std::dynamic_pointer_cast<VarRefNode>(expr)) return hasLocal(v->local);
+        return false;
+    }
+
+    // Literal atau lokal yang alamatnya tidak diambil: nilainya tidak bisa
+    // diubah oleh ekspresi lain, jadi boleh dimuat belakangan.
+    bool isStable(const NodePtr& expr) {
+        if (!isSimple(expr)) return false;
+        auto v = std::dynamic_pointer_cast<VarRefNode>(expr);
+        return !v || !addressTaken.count(v->local);
+    }
+
+    // Operand biner: lhs ke x1, rhs ke x0. rhs yang bukan literal/lokal bisa
+    // memakai x1 (call, index, operasi bersarang), jadi lhs di-spill dulu
+    // kecuali lhs sendiri bisa dimuat setelah rhs.
+    void genOperands(const NodePtr& lhs, const NodePtr& rhs) {
+        if (isSimple(rhs)) {
+            genExpr(lhs);
+            emit("  mov x1, x0");
+            genSimpleInto(rhs, "x0");
+        } else if (isStable(lhs)) {
+            genExpr(rhs);
+            genSimpleInto(lhs, "x1");
+        } else {
+            genExpr(lhs);
+            push("x0");
+            genExpr(rhs);
+            pop("x1");
+        }
+    }
+
+    static bool isComparison(const std::string& op) {
+        return op == "==" || op == "!=" || op == "<" || op == "<=" || op == ">" || op == ">=";
+    }
+
+    // Kode kondisi "lhs op rhs"; perbandingan bertanda hanya jika salah satu
+    // operand bertipe bertanda.
+    std::string compareCond(const std::shared_ptr<BinaryOpNode>& bin) {
+        bool sgn = layouts.isSigned(typeOf(bin->lhs)) || layouts.isSigned(typeOf(bin->rhs));
+        if (bin->op == "==") return "eq";
+        if (bin->op == "!=") return "ne";
+        if (bin->op == "<") return sgn ? "lt" : "lo";
+        if (bin->op == "<=") return sgn ? "le" : "ls";
+        if (bin->op == ">") return sgn ? "gt" : "hi";
+        return sgn ? "ge" : "hs";
+    }
+
+    static std::string invertCond(const std::string& cond) {
+        static const std::pair<const char*, const char*> pairs[] = {
+            {"eq", "ne"}, {"lt", "ge"}, {"le", "gt"}, {"lo", "hs"}, {"ls", "hi"}};
+        for (auto& [a, b] : pairs) {
+            if (cond == a) return b;
+            if (cond == b) return a;
+        }
+        throw std::runtime_error("cannot invert condition " + cond);
+    }
+
+    static bool isZero(const NodePtr& expr) {
+        auto lit = std::dynamic_pointer_cast<LiteralNode>(expr);
+        return lit && (lit->value == "0" || lit->value == "false");
+    }
+
+    // Lompat ke label jika nilai kebenaran expr sama dengan when, selain itu
+    // lanjut ke instruksi berikutnya. Perbandingan langsung menjadi cmp +
+    // b.cond (atau cbz/cbnz terhadap nol) tanpa cset; and/or mengevaluasi
+    // operand kanan hanya bila hasilnya belum pasti.
+    void genBranch(const NodePtr& expr, const std::string& label, bool when) {
+        if (auto bin = std::dynamic_pointer_cast<BinaryOpNode>(expr)) {
+            if (bin->op == "and" || bin->op == "or") {
+                if ((bin->op == "and") != when) {
+                    genBranch(bin->lhs, label, when);
+                    genBranch(bin->rhs, label, when);
+                } else {
+                    std::string skip = uniqueLabel("sc");
+                    genBranch(bin->lhs, skip, !when);
+                    genBranch(bin->rhs, label, when);
+                    emitLabel(skip);
+                }
+                return;
+            }
+            if (isComparison(bin->op)) {
+                if ((bin->op == "==" || bin->op == "!=") && (isZero(bin->rhs) || isZero(bin->lhs))) {
+                    std::string reg = genValue(isZero(bin->rhs) ? bin->lhs : bin->rhs);
+                    bool onZero = (bin->op == "==") == when;
+                    emit(std::string(onZero ? "  cbz " : "  cbnz ") + reg + ", " + label);
+                    return;
+                }
+                std::string cond = genCompare(bin);
+                emit("  b." + (when ? cond : invertCond(cond)) + " " + label);
+                return;
+            }
+        }
+        if (auto un = std::dynamic_pointer_cast<UnaryOpNode>(expr)) {
+            if (un->op == "!") {
+                genBranch(un->rhs, label, !when);
+                return;
+            }
+        }
+        if (auto lit = std::dynamic_pointer_cast<LiteralNode>(expr)) {
+            if (lit->value == "true" || lit->value == "false") {
+                if ((lit->value == "true") == when) emit("  b " + label);
+                return;
+            }
+        }
+        std::string reg = genValue(expr);
+        emit(std::string(when ? "  cbnz " : "  cbz ") + reg + ", " + label);
+    }
+
+    // ---- seleksi instruksi untuk operator biner ----
+
+    // Literal bilangan (bukan string/bool).
+    static bool constValue(const NodePtr& expr, uint64_t& value) {
+        auto lit = std::dynamic_pointer_cast<LiteralNode>(expr);
+        if (!lit || lit->value.empty() || !isdigit((unsigned char)lit->value[0])) return false;
+        value = std::stoull(lit->value, nullptr, 0);
+        return true;
+    }
+
+    static bool isPow2(uint64_t v) { return v && !(v & (v - 1)); }
+    static int log2(uint64_t v) { int k = 0; while (v >>= 1) ++k; return k; }
+
+    // Immediate add/sub/cmp: 12 bit, opsional digeser 12.
+    static std::string arithImm(uint64_t v) {
+        if (v < 4096) return "#" + std::to_string(v);
+        if (v < (1ULL << 24) && (v & 0xfff) == 0) return "#" + std::to_string(v >> 12) + ", lsl #12";
+        return "";
+    }
+
+    // Register home lokal fungsi leaf, atau "" jika nilainya harus dimuat.
+    std::string homeReg(const NodePtr& expr) {
+        auto v = std::dynamic_pointer_cast<VarRefNode>(expr);
+        if (!v) return "";
+        auto r = localRegs.find(v->local);
+        return r == localRegs.end() ? "" : r->second;
+    }
+
+    // Nilai expr di register: home lokal langsung, selain itu x0.
+    std::string genValue(const NodePtr& expr) {
+        std::string home = homeReg(expr);
+        if (!home.empty()) return home;
+        genExpr(expr);
+        return "x0";
+    }
+
+    // Seperti genOperands, tetapi lokal ber-register dipakai tanpa mov.
+    std::pair<std::string, std::string> genOperandRegs(const NodePtr& lhs, const NodePtr& rhs) {
+        std::string l = homeReg(lhs), r = homeReg(rhs);
+        if (!l.empty() && !r.empty()) return {l, r};
+        if (!r.empty()) return {genValue(lhs), r};
+        if (!l.empty()) {
+            genExpr(rhs);
+            return {l, "x0"};
+        }
+        genOperands(lhs, rhs);
+        return {"x1", "x0"};
+    }
+
+    static std::string swapCond(const std::string& cond) {
+        static const std::pair<const char*, const char*> pairs[] = {{"lt", "gt"}, {"le", "ge"}, {"lo", "hi"}, {"ls", "hs"}};
+        for (auto& [a, b] : pairs) {
+            if (cond == a) return b;
+            if (cond == b) return a;
+        }
+        return cond;
+    }
+
+    // cmp untuk perbandingan; konstanta kecil menjadi immediate (operand
+    // ditukar bila konstantanya di kiri). Hasil: kode kondisi.
+    std::string genCompare(const std::shared_ptr<BinaryOpNode>& bin) {
+        uint64_t c;
+        std::string imm;
+        if (constValue(bin->rhs, c) && !(imm = arithImm(c)).empty()) {
+            emit("  cmp " + genValue(bin->lhs) + ", " + imm);
+            return compareCond(bin);
+        }
+        if (constValue(bin->lhs, c) && !(imm = arithImm(c)).empty()) {
+            emit("  cmp " + genValue(bin->rhs) + ", " + imm);
+            return swapCond(compareCond(bin));
+        }
+        auto [l, r] = genOperandRegs(bin->lhs, bin->rhs);
+        emit("  cmp " + l + ", " + r);
+        return compareCond(bin);
+    }
+
+    bool isSignedOp(const std::shared_ptr<BinaryOpNode>& bin) {
+        return layouts.isSigned(typeOf(bin->lhs)) || layouts.isSigned(typeOf(bin->rhs));
+    }
+
+    // + - * / % ke x0. Konstanta di kanan memakai immediate, shift, atau
+    // perkalian magic; a + b*c menjadi madd.
+    void genArith(const std::shared_ptr<BinaryOpNode>& bin) {
+        const std::string& op = bin->op;
+        bool sgn = isSignedOp(bin);
+        if ((op == "+" || op == "-") && genFusedMul(bin)) return;
+
+        NodePtr lhs = bin->lhs, rhs = bin->rhs;
+        uint64_t c;
+        if ((op == "+" || op == "*") && !constValue(rhs, c) && constValue(lhs, c)) std::swap(lhs, rhs);
+        if (constValue(rhs, c)) {
+            std::string imm = arithImm(c);
+            if ((op == "+" || op == "-") && !imm.empty()) {
+                std::string l = genValue(lhs);
+                emit("  " + std::string(op == "+" ? "add" : "sub") + " x0, " + l + ", " + imm);
+                return;
+            }
+            if (op == "*") {
+                genMulConst(genValue(lhs), c);
+                return;
+            }
+            if ((op == "/" || op == "%") && c != 0) {
+                std::string l = genValue(lhs);
+                if (op == "/") genDivConst("x0", l, c, sgn);
+                else genModConst(l, c, sgn);
+                return;
+            }
+        }
+
+        auto [l, r] = genOperandRegs(lhs, rhs);
+        std::string div = sgn ? "sdiv" : "udiv";
+        if (op == "+") emit("  add x0, " + l + ", " + r);
+        else if (op == "-") emit("  sub x0, " + l + ", " + r);
+        else if (op == "*") emit("  mul x0, " + l + ", " + r);
+        else if (op == "/") emit("  " + div + " x0, " + l + ", " + r);
+        else if (op == "%") {
+            emit("  " + div + " x2, " + l + ", " + r);
+            emit("  msub x0, x2, " + r + ", " + l);
+        }
+    }
+
+    void genMulConst(const std::string& l, uint64_t c) {
+        if (c == 0) emit("  mov x0, #0");
+        else if (c == 1) { if (l != "x0") emit("  mov x0, " + l); }
+        else if (isPow2(c)) emit("  lsl x0, " + l + ", #" + std::to_string(log2(c)));
+        else if (isPow2(c - 1)) emit("  add x0, " + l + ", " + l + ", lsl #" + std::to_string(log2(c - 1)));
+        else if (isPow2(c + 1)) {
+            emit("  lsl x1, " + l + ", #" + std::to_string(log2(c + 1)));
+            emit("  sub x0, x1, " + l);
+        } else {
+            emitMovImm("x1", c);
+            emit("  mul x0, " + l + ", x1");
+        }
+    }
+
+    // dst = l / c (c != 0). Unsigned: shift atau umulh dengan konstanta magic
+    // (Granlund-Montgomery); signed: shift dengan koreksi pembulatan ke nol,
+    // selain pangkat dua tetap sdiv. Memakai x1, x2; l bukan x1/x2.
+    void genDivConst(const std::string& dst, const std::string& l, uint64_t c, bool sgn) {
+        if (c == 1) {
+            if (dst != l) emit("  mov " + dst + ", " + l);
+            return;
+        }
+        if (sgn) {
+            if (isPow2(c) && c < (1ULL << 63)) {
+                int k = log2(c);
+                emitAddImm("x1", l, (long long)(c - 1));
+                emit("  cmp " + l + ", #0");
+                emit("  csel x1, x1, " + l + ", lt");
+                emit("  asr " + dst + ", x1, #" + std::to_string(k));
+            } else {
+                emitMovImm("x1", c);
+                emit("  sdiv " + dst + ", " + l + ", x1");
+            }
+            return;
+        }
+        if (isPow2(c)) {
+            emit("  lsr " + dst + ", " + l + ", #" + std::to_string(log2(c)));
+            return;
+        }
+        if (c > (1ULL << 63)) {
+            // Hasil hanya 0 atau 1.
+            emitMovImm("x1", c);
+            emit("  cmp " + l + ", x1");
+            emit("  cset " + dst + ", hs");
+            return;
+        }
+        // Cari s terkecil dengan m = ceil(2^(64+s) / c) dan m*c - 2^(64+s) <= 2^s.
+        typedef unsigned __int128 u128;
+        int s = 0;
+        u128 m = 0;
+        for (; s < 64; ++s) {
+            u128 pow = (u128)1 << (64 + s);
+            m = pow / c + 1;
+            if (m * c - pow <= ((u128)1 << s)) break;
+        }
+        if (m >> 64 == 0) {
+            emitMovImm("x1", (uint64_t)m);
+            emit("  umulh x1, " + l + ", x1");
+            if (s) emit("  lsr " + dst + ", x1, #" + std::to_string(s));
+            else emit("  mov " + dst + ", x1");
+        } else {
+            // m butuh 65 bit: q = umulh(n, m - 2^64); ((n - q) / 2 + q) >> (s - 1).
+            emitMovImm("x1", (uint64_t)m);
+            emit("  umulh x1, " + l + ", x1");
+            emit("  sub x2, " + l + ", x1");
+            emit("  add x1, x1, x2, lsr #1");
+            emit("  lsr " + dst + ", x1, #" + std::to_string(s - 1));
+        }
+    }
+
+    void genModConst(const std::string& l, uint64_t c, bool sgn) {
+        if (c == 1) {
+            emit("  mov x0, #0");
+        } else if (!sgn && isPow2(c)) {
+            emit("  and x0, " + l + ", #" + std::to_string(c - 1));
+        } else {
+            genDivConst("x1", l, c, sgn);
+            emitMovImm("x2", c);
+            emit("  msub x0, x1, x2, " + l);
+        }
+    }
+
+    // a + b*c -> madd, a - b*c -> msub; b*2^k menjadi operand tergeser.
+    bool genFusedMul(const std::shared_ptr<BinaryOpNode>& bin) {
+        auto mulOf = [](const NodePtr& e) {
+            auto m = std::dynamic_pointer_cast<BinaryOpNode>(e);
+            return m && m->op == "*" ? m : nullptr;
+        };
+        NodePtr addend = bin->lhs;
+        auto mul = mulOf(bin->rhs);
+        if (!mul && bin->op == "+") {
+            mul = mulOf(bin->lhs);
+            addend = bin->rhs;
+        }
+        if (!mul) return false;
+
+        uint64_t c;
+        NodePtr factor = mul->lhs;
+        if (constValue(mul->lhs, c) && !constValue(mul->rhs, c)) factor = mul->rhs;
+        if (constValue(factor == mul->lhs ? mul->rhs : mul->lhs, c)) {
+            if (!isPow2(c)) return false; // konstanta lain: genMulConst lebih murah
+            auto [l, r] = genOperandRegs(addend, factor);
+            emit("  " + std::string(bin->op == "+" ? "add" : "sub") + " x0, " + l + ", " + r + ", lsl #" + std::to_string(log2(c)));
+            return true;
+        }
+
+        std::string a = homeReg(addend);
+        if (a.empty() && !isStable(addend)) {
+            genExpr(addend);
+            push("x0");
+        }
+        auto [l, r] = genOperandRegs(mul->lhs, mul->rhs);
+        if (a.empty()) {
+            a = "x2";
+            if (isStable(addend)) genSimpleInto(addend, a);
+            else pop(a);
+        }
+        emit("  " + std::string(bin->op == "+" ? "madd" : "msub") + " x0, " + l + ", " + r + ", " + a);
+        return true;
+    }
+
+    // Rantai if/elseif "x == konstanta" pada lokal yang sama: tabel lompatan
+    // bila konstantanya rapat, selain itu pohon keputusan biner. Kasus
+    // duplikat tidak pernah terpilih di rantai aslinya, jadi dibuang.
+    bool genSwitch(const std::shared_ptr<IfStmtNode>& i) {
+        static const size_t MinCases = 4;
+        if (i->branches.size() < MinCases) return false;
+        int local = -1;
+        NodePtr subject;
+        std::vector<std::pair<uint64_t, size_t>> cases; // konstanta, indeks branch
+        std::set<uint64_t> seen;
+        for (size_t j = 0; j < i->branches.size(); ++j) {
+            auto cmp = std::dynamic_pointer_cast<BinaryOpNode>(i->branches[j].first);
+            if (!cmp || cmp->op != "==") return false;
+            uint64_t value;
+            NodePtr operand = cmp->lhs;
+            if (!constValue(cmp->rhs, value)) {
+                if (!constValue(cmp->lhs, value)) return false;
+                operand = cmp->rhs;
+            }
+            auto v = std::dynamic_pointer_cast<VarRefNode>(operand);
+            if (!v || !hasLocal(v->local) || (local >= 0 && v->local != local)) return false;
+            local = v->local;
+            subject = operand;
+            if (seen.insert(value).second) cases.push_back({value, j});
+        }
+        TypeId type = typeOf(subject);
+        if (!types.isInteger(type) || cases.size() < MinCases) return false;
+
+        std::vector<std::string> labels;
+        for (size_t j = 0; j < i->branches.size(); ++j) labels.push_back(uniqueLabel("case"));
+        std::string defaultLabel = uniqueLabel("default");
+        std::string endLabel = uniqueLabel("endswitch");
+
+        std::string v = genValue(subject);
+
+        std::vector<std::pair<uint64_t, size_t>> sorted = cases;
+        std::sort(sorted.begin(), sorted.end());
+        uint64_t lo = sorted.front().first, range = sorted.back().first - lo;
+        if (range < 1024 && range < 3 * sorted.size()) {
+            if (lo) emitAddImm("x1", v, -(long long)lo);
+            else emit("  mov x1, " + v);
+            emitCompareImm("x1", range, "x2");
+            emit("  b.hi " + defaultLabel);
+            std::string table = uniqueLabel("jt");
+            emit("  adr x2, " + table);
+            emit("  ldrsw x1, [x2, x1, lsl #2]");
+            emit("  add x2, x2, x1");
+            emit("  br x2");
+            emitLabel(table);
+            size_t next = 0;
+            for (uint64_t k = 0; k <= range; ++k) {
+                std::string target = defaultLabel;
+                if (sorted[next].first == lo + k) target = labels[sorted[next++].second];
+                emit("  .word " + target + " - " + table);
+            }
+        } else {
+            bool sgn = layouts.isSigned(type);
+            genDecisionTree(v, sorted, 0, sorted.size(), labels, defaultLabel, sgn);
+        }
+
+        for (auto& [value, j] : cases) {
+            emitLabel(labels[j]);
+            genBlock(std::dynamic_pointer_cast<BlockNode>(i->branches[j].second));
+            emit("  b " + endLabel);
+        }
+        emitLabel(defaultLabel);
+        if (i->elseBlock) genBlock(std::dynamic_pointer_cast<BlockNode>(i->elseBlock));
+        emitLabel(endLabel);
+        return true;
+    }
+
+    // cmp reg, #value; konstanta besar lewat scratch.
+    void emitCompareImm(const std::string& reg, uint64_t value, const std::string& scratch) {
+        std::string imm = arithImm(value);
+        if (imm.empty()) {
+            emitMovImm(scratch, value);
+            imm = scratch;
+        }
+        emit("  cmp " + reg + ", " + imm);
+    }
+
+    // Pencarian biner atas kasus terurut [from, to): O(log n) perbandingan.
+    void genDecisionTree(const std::string& v, const std::vector<std::pair<uint64_t, size_t>>& cases, size_t from, size_t to,
+                         const std::vector<std::string>& labels, const std::string& defaultLabel, bool sgn) {
+        if (to - from <= 3) {
+            for (size_t k = from; k < to; ++k) {
+                emitCompareImm(v, cases[k].first, "x1");
+                emit("  b.eq " + labels[cases[k].second]);
+            }
+            emit("  b " + defaultLabel);
+            return;
+        }
+        size_t mid = from + (to - from) / 2;
+        std::string upper = uniqueLabel("upper");
+        emitCompareImm(v, cases[mid].first, "x1");
+        emit("  b.eq " + labels[cases[mid].second]);
+        emit(std::string("  b.") + (sgn ? "gt " : "hi ") + upper);
+        genDecisionTree(v, cases, from, mid, labels, defaultLabel, sgn);
+        emitLabel(upper);
+        genDecisionTree(v, cases, mid + 1, to, labels, defaultLabel, sgn);
+    }
+
+    // if c { x = a } [else { x = b }] dengan a, b literal/lokal: cmp + csel
+    // tanpa branch.
+    bool genSelect(const std::shared_ptr<IfStmtNode>& i) {
+        if (i->branches.size() != 1) return false;
+        auto cmp = std::dynamic_pointer_cast<BinaryOpNode>(i->branches[0].first);
+        if (!cmp || !isComparison(cmp->op)) return false;
+        auto assignIn = [&](const NodePtr& blk) -> std::shared_ptr<AssignStmtNode> {
+            auto b = std::dynamic_pointer_cast<BlockNode>(blk);
+            if (!b || b->statements.size() != 1) return nullptr;
+            auto a = std::dynamic_pointer_cast<AssignStmtNode>(b->statements[0]);
+            if (!a || !isSimple(a->expr)) return nullptr;
+            auto v = std::dynamic_pointer_cast<VarRefNode>(a->lhs);
+            if (!v || !hasLocal(v->local) || isAggregate(localTypes[v->local])) return nullptr;
+            return a;
+        };
+        auto thenAssign = assignIn(i->branches[0].second);
+        if (!thenAssign) return false;
+        int local = std::dynamic_pointer_cast<VarRefNode>(thenAssign->lhs)->local;
+        std::shared_ptr<AssignStmtNode> elseAssign;
+        if (i->elseBlock) {
+            elseAssign = assignIn(i->elseBlock);
+            if (!elseAssign || std::dynamic_pointer_cast<VarRefNode>(elseAssign->lhs)->local != local) return false;
+        }
+
+        std::string cond = genCompare(cmp);
+        // Muat nilai setelah cmp: mov/ldr tidak mengubah flag.
+        auto valueIn = [&](const NodePtr& e, const std::string& scratch) {
+            std::string home = homeReg(e);
+            if (!home.empty()) return home;
+            if (isZero(e)) return std::string("xzr");
+            genSimpleInto(e, scratch);
+            return scratch;
+        };
+        std::string a = valueIn(thenAssign->expr, "x2");
+        std::string b;
+        if (elseAssign) {
+            b = valueIn(elseAssign->expr, "x3");
+        } else {
+            b = valueIn(thenAssign->lhs, "x3");
+        }
+        emit("  csel x0, " + a + ", " + b + ", " + cond);
+        storeLocal("x0", local);
+        return true;
+    }
+
+    // Loop terhitung yang dijalankan per vektor NEON 128 bit:
+    //   while i < n { a[i] = <ekspresi elemen>; ...; i = i + 1 }
+    // Elemen u8/u16 (i8/i16), operator + - *, operand a[i], literal, lokal
+    // invarian, atau lokal yang dideklarasikan di body.
+    struct VectorLoop {
+        int counter = -1;
+        NodePtr limit;
+        int elemSize = 0;
+        std::vector<NodePtr> body;      // statement tanpa i = i + 1
+        std::vector<int> arrays;        // lokal array, urut kemunculan
+        std::vector<int> stored;        // lokal array yang ditulis
+        std::vector<NodePtr> invariants; // literal/lokal yang di-dup ke vektor
+        int nodes = 0;                  // a[i], operator dan deklarasi: satu register vektor
+    };
+
+    bool isUnsignedLocal(const NodePtr& expr) {
+        auto v = std::dynamic_pointer_cast<VarRefNode>(expr);
+        return v && hasLocal(v->local) && !addressTaken.count(v->local) && types.isInteger(typeOf(v)) && !types.isSigned(typeOf(v));
+    }
+
+    // Alasan loop tidak bisa divektorkan; kosong jika bisa.
+    std::string vectorPlan(const std::shared_ptr<WhileStmtNode>& w, VectorLoop& plan) {
+        auto cond = std::dynamic_pointer_cast<BinaryOpNode>(w->cond);
+        long long k;
+        if (!cond || cond->op != "<" || !isUnsignedLocal(cond->lhs) ||
+            !(isUnsignedLocal(cond->rhs) || isConstInt(cond->rhs, k)))
+            return "condition is not 'i < n' on unsigned locals";
+        plan.counter = std::dynamic_pointer_cast<VarRefNode>(cond->lhs)->local;
+        plan.limit = cond->rhs;
+        if (auto n = std::dynamic_pointer_cast<VarRefNode>(cond->rhs)) {
+            if (n->local == plan.counter) return "condition is not 'i < n' on unsigned locals";
+        }
+
+        auto& stmts = std::dynamic_pointer_cast<BlockNode>(w->block)->statements;
+        auto step = stmts.empty() ? nullptr : std::dynamic_pointer_cast<AssignStmtNode>(stmts.back());
+        auto inc = step ? std::dynamic_pointer_cast<BinaryOpNode>(step->expr) : nullptr;
+        auto isCounter = [&](const NodePtr& e) {
+            auto v = std::dynamic_pointer_cast<VarRefNode>(e);
+            return v && v->local == plan.counter;
+        };
+        if (!inc || !isCounter(step->lhs) || inc->op != "+" || !isCounter(inc->lhs) || !isConstInt(inc->rhs, k) || k != 1)
+            return "loop does not end with 'i = i + 1'";
+        if (stmts.size() < 2) return "loop has no array stores";
+
+        std::unordered_set<int> declared;
+        size_t s = 0; // statement body yang sedang diperiksa (untuk pesan remark)
+        auto useArray = [&](const NodePtr& arr, const NodePtr& index, bool store) -> std::string {
+            auto a = std::dynamic_pointer_cast<VarRefNode>(arr);
+            if (!a || !hasLocal(a->local) || addressTaken.count(a->local) || a->isVolatile)
+                return "array is not a plain local";
+            if (!isCounter(index)) return "array '" + a->name + "' is not indexed by the loop counter";
+            TypeId elem = elementType(typeOf(a));
+            if (!types.isInteger(elem) || (layouts.sizeOf(elem) != 1 && layouts.sizeOf(elem) != 2))
+                return "element type of '" + a->name + "' is not u8/u16";
+            int size = layouts.sizeOf(elem);
+            if (plan.elemSize && plan.elemSize != size) return "arrays mix element widths";
+            plan.elemSize = size;
+            if (std::find(plan.arrays.begin(), plan.arrays.end(), a->local) == plan.arrays.end()) plan.arrays.push_back(a->local);
+            if (store && std::find(plan.stored.begin(), plan.stored.end(), a->local) == plan.stored.end()) plan.stored.push_back(a->local);
+            return "";
+        };
+        std::function<std::string(const NodePtr&)> element = [&](const NodePtr& e) -> std::string {
+            switch (e->kind) {
+                case NodeKind::ArrayIndex: {
+                    auto ai = std::dynamic_pointer_cast<ArrayIndexNode>(e);
+                    ++plan.nodes;
+                    return useArray(ai->array, ai->index, false);
+                }
+                case NodeKind::Literal:
+                    if (!isConstInt(e, k)) return "operand is not an integer";
+                    plan.invariants.push_back(e);
+                    return "";
+                case NodeKind::VarRef: {
+                    auto v = std::dynamic_pointer_cast<VarRefNode>(e);
+                    if (v->local == plan.counter) return "loop counter is used as a value";
+                    if (declared.count(v->local)) return "";
+                    if (!hasLocal(v->local) || addressTaken.count(v->local) || !types.isInteger(typeOf(v)))
+                        return "operand '" + v->name + "' is not an integer local";
+                    plan.invariants.push_back(e);
+                    return "";
+                }
+                case NodeKind::BinaryOp: {
+                    auto b = std::dynamic_pointer_cast<BinaryOpNode>(e);
+                    if (b->op != "+" && b->op != "-" && b->op != "*") return "operator '" + b->op + "' has no NEON form";
+                    ++plan.nodes;
+                    std::string why = element(b->lhs);
+                    return why.empty() ? element(b->rhs) : why;
+                }
+                default:
+                    return "operand in statement " + std::to_string(s + 1) + " of the body is not element-wise";
+            }
+        };
+        for (s = 0; s + 1 < stmts.size(); ++s) {
+            const NodePtr& stmt = stmts[s];
+            std::string why;
+            if (auto a = std::dynamic_pointer_cast<AssignStmtNode>(stmt)) {
+                auto ai = std::dynamic_pointer_cast<ArrayIndexNode>(a->lhs);
+                if (!ai) return "statement " + std::to_string(s + 1) + " of the body is not an element store";
+                why = element(a->expr);
+                if (why.empty()) why = useArray(ai->array, ai->index, true);
+            } else if (auto d = std::dynamic_pointer_cast<DeclStmtNode>(stmt)) {
+                if (!types.isInteger(d->type)) return "declaration " + std::to_string(s + 1) + " of the body is not an integer";
+                why = element(d->expr);
+                ++plan.nodes;
+                declared.insert(d->local);
+            } else {
+                return "statement " + std::to_string(s + 1) + " of the body is not an element store";
+            }
+            if (!why.empty()) return why;
+            plan.body.push_back(stmt);
+        }
+        if (plan.stored.empty()) return "loop has no array stores";
+        if (plan.nodes + plan.invariants.size() > 16) return "body needs more than 16 vector registers";
+        return "";
+    }
+
+    // Register vektor: v16..v31 (caller-saved, tidak ada panggilan di loop).
+    std::string vreg(int v, int elemSize) {
+        return "v" + std::to_string(v) + (elemSize == 1 ? ".16b" : elemSize == 2 ? ".8h" : ".4s");
+    }
+
+    // x3 = alamat a[i]; i ada di x2.
+    void emitElementAddress(const NodePtr& arr, int elemSize) {
+        loadLocal("x3", std::dynamic_pointer_cast<VarRefNode>(arr)->local);
+        emit("  add x3, x3, x2" + std::string(elemSize == 2 ? ", lsl #1" : ""));
+    }
+
+    // Hasil ekspresi elemen di register vektor baru.
+    int genVectorExpr(const NodePtr& e, const VectorLoop& plan, std::unordered_map<const Node*, int>& splat,
+                      std::unordered_map<int, int>& named, int& next) {
+        if (auto ai = std::dynamic_pointer_cast<ArrayIndexNode>(e)) {
+            emitElementAddress(ai->array, plan.elemSize);
+            int r = next++;
+            emit("  ld1 {" + vreg(r, plan.elemSize) + "}, [x3]");
+            return r;
+        }
+        if (auto v = std::dynamic_pointer_cast<VarRefNode>(e)) {
+            auto it = named.find(v->local);
+            if (it != named.end()) return it->second;
+        }
+        if (auto b = std::dynamic_pointer_cast<BinaryOpNode>(e)) {
+            int l = genVectorExpr(b->lhs, plan, splat, named, next);
+            int r = genVectorExpr(b->rhs, plan, splat, named, next);
+            int d = next++;
+            std::string op = b->op == "+" ? "add" : b->op == "-" ? "sub" : "mul";
+            emit("  " + op + " " + vreg(d, plan.elemSize) + ", " + vreg(l, plan.elemSize) + ", " + vreg(r, plan.elemSize));
+            return d;
+        }
+        return splat.at(e.get());
+    }
+
+    // Bagian vektor dari loop; sisa iterasi (dan loop yang array-nya tumpang
+    // tindih kurang dari 16 byte) dikerjakan loop skalar setelahnya.
+    void genVectorLoop(const VectorLoop& plan) {
+        int lanes = 16 / plan.elemSize;
+        std::string done = uniqueLabel("vec_done");
+        std::string body = uniqueLabel("vec_body");
+        std::string test = uniqueLabel("vec_cond");
+
+        // Dua array di memori yang sama berjarak 1..15 byte: hasil per vektor
+        // berbeda dari per elemen. Dua array inline di frame tidak tumpang tindih.
+        for (int s : plan.stored) {
+            for (int a : plan.arrays) {
+                if (a == s || (inlineLocals.count(a) && inlineLocals.count(s))) continue;
+                if (a < s && std::find(plan.stored.begin(), plan.stored.end(), a) != plan.stored.end()) continue;
+                std::string ok = uniqueLabel("vec_alias");
+                loadLocal("x2", s);
+                loadLocal("x3", a);
+                emit("  sub x2, x2, x3");
+                emit("  cbz x2, " + ok);
+                emit("  add x2, x2, #15");
+                emit("  cmp x2, #30");
+                emit("  b.ls " + done);
+                emitLabel(ok);
+            }
+        }
+
+        int next = 16;
+        std::unordered_map<const Node*, int> splat;
+        std::unordered_map<int, int> named;
+        for (auto& inv : plan.invariants) {
+            genExpr(inv);
+            splat[inv.get()] = next;
+            emit("  dup " + vreg(next++, plan.elemSize) + ", w0");
+        }
+        emit("  b " + test);
+        emitLabel(body);
+        loadLocal("x2", plan.counter);
+        for (auto& stmt : plan.body) {
+            if (auto d = std::dynamic_pointer_cast<DeclStmtNode>(stmt)) {
+                named[d->local] = genVectorExpr(d->expr, plan, splat, named, next);
+                continue;
+            }
+            auto a = std::dynamic_pointer_cast<AssignStmtNode>(stmt);
+            int r = genVectorExpr(a->expr, plan, splat, named, next);
+            emitElementAddress(std::dynamic_pointer_cast<ArrayIndexNode>(a->lhs)->array, plan.elemSize);
+            emit("  st1 {" + vreg(r, plan.elemSize) + "}, [x3]");
+        }
+        emit("  add x2, x2, #" + std::to_string(lanes));
+        storeLocal("x2", plan.counter);
+        emitLabel(test);
+        genExpr(plan.limit);
+        loadLocal("x2", plan.counter);
+        emit("  cmp x2, x0");
+        emit("  b.hs " + done);
+        emit("  sub x0, x0, x2");
+        emit("  cmp x0, #" + std::to_string(lanes));
+        emit("  b.hs " + body);
+        emitLabel(done);
+    }
+
+    void remark(const NodePtr& at, const std::string& message) {
+        remarks.push_back({at->line, at->column, functionName + ": " + message});
+    }
+
+    // Ada panggilan fungsi (yang boleh menimpa v0..v31) di dalam expr?
+    static bool callsFunction(const NodePtr& expr) {
+        auto c = std::dynamic_pointer_cast<CallNode>(expr);
+        if (c && !c->builtin) return true;
+        bool found = false;
+        visitChildren(expr, [&](const NodePtr& n) { if (!found) found = callsFunction(n); });
+        return found;
+    }
+
+    int laneSize(TypeId vec) {
+        return layouts.sizeOf(types.lane(vec));
+    }
+
+    // ldr/str qN; offset di luar jangkauan dihitung ke register scratch.
+    void emitVectorMem(const std::string& op, int v, AddrMode a) {
+        legalize(a, 16);
+        if (!a.index.empty()) materialize(a);
+        emit("  " + op + " q" + std::to_string(v) + ", " + a.str());
+    }
+
+    // x0..x2 = alamat a[i] untuk vload/vstore; register hasil dikembalikan.
+    std::string genLaneAddress(const std::shared_ptr<CallNode>& call) {
+        auto ai = std::make_shared<ArrayIndexNode>(call->args[0], call->args[1]);
+        ai->line = call->line;
+        TypeId elem;
+        AddrMode a = genAddress(ai, elem);
+        return materialize(a);
+    }
+
+    // Nilai vektor expr ke v<d>. Operand kiri tetap di register selama operand
+    // kanan dihitung di v<d+1>; kalau operand kanan memanggil fungsi (atau
+    // register habis) operand kiri di-spill dan dimuat kembali ke v7.
+    void genVectorInto(const NodePtr& expr, int d, int es) {
+        std::string v = vreg(d, es);
+        auto bin = std::dynamic_pointer_cast<BinaryOpNode>(expr);
+        auto call = std::dynamic_pointer_cast<CallNode>(expr);
+        if (call && !call->builtin) call = nullptr;
+        if (!types.isVector(typeOf(expr)) || (call && call->name == "vsplat")) {
+            genExpr(call ? call->args[0] : expr);
+            emit("  dup " + v + ", w0");
+            return;
+        }
+        if (bin || (call && (call->name == "vmin" || call->name == "vmax"))) {
+            const NodePtr& lhs = bin ? bin->lhs : call->args[0];
+            const NodePtr& rhs = bin ? bin->rhs : call->args[1];
+            std::string op = !bin ? "u" + call->name.substr(1) : bin->op == "+" ? "add" : bin->op == "-" ? "sub" : "mul";
+            genVectorInto(lhs, d, es);
+            if (callsFunction(rhs) || d == 31) {
+                emit("  str q" + std::to_string(d) + ", [sp, #-16]!");
+                spDepth += 16;
+                genVectorInto(rhs, d, es);
+                emit("  ldr q7, [sp], #16");
+                spDepth -= 16;
+                emit("  " + op + " " + v + ", " + vreg(7, es) + ", " + v);
+            } else {
+                genVectorInto(rhs, d + 1, es);
+                emit("  " + op + " " + v + ", " + v + ", " + vreg(d + 1, es));
+            }
+            return;
+        }
+        if (call && call->name == "vload") {
+            emit("  ldr q" + std::to_string(d) + ", [" + genLaneAddress(call) + "]");
+            return;
+        }
+        // Vektor di memori (lokal, field, elemen, hasil fungsi).
+        auto var = std::dynamic_pointer_cast<VarRefNode>(expr);
+        if (var && inlineLocals.count(var->local) && !localRegs.count(var->local)) {
+            emitVectorMem("ldr", d, AddrMode{"x29", "", 0, localOffsets[var->local]});
+            return;
+        }
+        genExpr(expr);
+        emit("  ldr q" + std::to_string(d) + ", [x0]");
+    }
+
+    // Hasil vektor ke temporer baru di frame; x0 = alamatnya.
+    void genVectorTemp(const NodePtr& expr, TypeId type) {
+        genVectorInto(expr, 16, laneSize(type));
+        lastTemp = allocFrame(16, 16);
+        emitVectorMem("str", 16, AddrMode{"x29", "", 0, lastTemp});
+        emitAddImm("x0", "x29", lastTemp);
+    }
+
+    // Ekspresi vektor yang dihitung ke temporer baru (bukan lokal/field/elemen).
+    bool isVectorTemp(const NodePtr& expr) {
+        auto call = std::dynamic_pointer_cast<CallNode>(expr);
+        return expr->kind == NodeKind::BinaryOp || expr->kind == NodeKind::Literal || (call && call->builtin);
+    }
+
+    // Atomik ke ldar/stlr, ldadd/cas (LSE) atau loop ldxr/stxr (ARMv8.0).
+    // Nilai kembali add/cas adalah nilai lama di memori.
+    void genAtomic(const std::shared_ptr<CallNode>& call) {
+        const std::string& order = call->order;
+        bool acquire = order == "acquire" || order == "acq_rel" || order == "seq_cst";
+        bool release = order == "release" || order == "acq_rel" || order == "seq_cst";
+        if (call->name == "atomic_fence") {
+            if (order != "relaxed") emit(order == "acquire" ? "  dmb ishld" : "  dmb ish");
+            return;
+        }
+        // Operand tanpa urutan memori: alamat ke x0, nilai ke x1 (dan x2).
+        auto operands = std::make_shared<CallNode>(*call);
+        operands->args.pop_back();
+        genCallArgs(operands);
+        TypeId type = elementType(typeOf(call->args[0]));
+        int size = layouts.sizeOf(type);
+        std::string sfx = size == 1 ? "b" : size == 2 ? "h" : "";
+        std::string r = size == 8 ? "x" : "w";
+        if (call->name == "atomic_load") {
+            emit(acquire ? "  ldar" + sfx + " " + r + "0, [x0]" : layouts.loadInstr(type, 0, "[x0]"));
+            return;
+        }
+        if (call->name == "atomic_store") {
+            emit(release ? "  stlr" + sfx + " " + r + "1, [x0]" : layouts.storeInstr(type, 1, "[x0]"));
+            return;
+        }
+        std::string load = std::string("  ld") + (acquire ? "a" : "") + "xr" + sfx + " " + r + "0, [x3]";
+        std::string store = std::string("  st") + (release ? "l" : "") + "xr" + sfx + " w16, " + r + "2, [x3]";
+        std::string lseOrder = std::string(acquire ? "a" : "") + (release ? "l" : "");
+        emit("  mov x3, x0");
+        if (call->name == "atomic_add") {
+            if (lse) {
+                emit("  ldadd" + lseOrder + sfx + " " + r + "1, " + r + "0, [x3]");
+                return;
+            }
+            std::string retry = uniqueLabel("atomic_add");
+            emitLabel(retry);
+            emit(load);
+            emit("  add " + r + "2, " + r + "0, " + r + "1");
+            emit(store);
+            emit("  cbnz w16, " + retry);
+            return;
+        }
+        // atomic_cas: x1 = nilai yang diharapkan, x2 = nilai baru.
+        if (lse) {
+            emit("  mov x0, x1");
+            emit("  cas" + lseOrder + sfx + " " + r + "0, " + r + "2, [x3]");
+            return;
+        }
+        // ldxrb/ldxrh memberi nilai zero-extend; samakan lebar nilai pembanding.
+        if (size < 4) emit("  and w1, w1, #" + std::string(size == 1 ? "0xff" : "0xffff"));
+        std::string retry = uniqueLabel("atomic_cas");
+        std::string done = uniqueLabel("atomic_cas_done");
+        emitLabel(retry);
+        emit(load);
+        emit("  cmp " + r + "0, " + r + "1");
+        emit("  b.ne " + done);
+        emit(store);
+        emit("  cbnz w16, " + retry);
+        emitLabel(done);
+    }
+
+    void genIntrinsic(const std::shared_ptr<CallNode>& call) {
+        if (call->name.rfind("atomic_", 0) == 0) {
+            genAtomic(call);
+        } else if (call->name == "vstore") {
+            TypeId vec = types.vectorOf(elementType(typeOf(call->args[0])));
+            genVectorInto(call->args[2], 16, laneSize(vec));
+            bool spill = callsFunction(call->args[0]) || callsFunction(call->args[1]);
+            if (spill) {
+                emit("  str q16, [sp, #-16]!");
+                spDepth += 16;
+            }
+            std::string addr = genLaneAddress(call);
+            if (spill) {
+                emit("  ldr q16, [sp], #16");
+                spDepth -= 16;
+            }
+            emit("  str q16, [" + addr + "]");
+        } else if (call->name == "vsum") {
+            // uaddlv melebar 2x: jumlah 16 lane u8 pun tidak meluap.
+            int es = laneSize(typeOf(call->args[0]));
+            genVectorInto(call->args[0], 16, es);
+            const char* sum = es == 1 ? "h7" : es == 2 ? "s7" : "d7";
+            emit("  uaddlv " + std::string(sum) + ", " + vreg(16, es));
+            emit(es == 4 ? "  fmov x0, d7" : "  fmov w0, s7");
+        } else {
+            genVectorTemp(call, typeOf(call));
+        }
+    }
+
+    void genSimpleInto(const NodePtr& expr, const std::string& reg) {
+        if (auto lit = std::dynamic_pointer_cast<LiteralNode>(expr)) {
+            if (lit->value == "true") emit("  mov " + reg + ", #1");
+            else if (lit->value == "false") emit("  mov " + reg + ", #0");
+            else emitMovImm(reg, std::stoull(lit->value, nullptr, 0));
+        } else {
+            loadLocal(reg, std::dynamic_pointer_cast<VarRefNode>(expr)->local);
+        }
+    }
+
+    // Isi temporer baru di frame dari daftar nilai; x0 = alamatnya. Nilai
+    // sederhana dimuat langsung, pasangan slot 8 byte bersebelahan memakai stp.
+    void genAggregateInit(const std::vector<NodePtr>& values, const std::vector<FieldLayout>& slots, int size, int align) {
+        int n = (int)values.size();
+        bool simple = true;
+        for (int i = 0; i < n; ++i) {
+            // Literal untuk field vektor perlu diisikan ke semua lane dulu.
+            if (!isSimple(values[i]) || (types.isVector(slots[i].type) && !types.isVector(typeOf(values[i])))) simple = false;
+        }
+
+        std::vector<int> pushedAt;
+        if (!simple) {
+            for (int i = 0; i < n; ++i) {
+                genExprAs(values[i], slots[i].type);
+                push("x0");
+                pushedAt.push_back(spDepth);
+            }
+        }
+        lastTemp = allocFrame(size, align);
+        emitAddImm("x0", "x29", lastTemp);
+
+        // Field tanpa inisialisasi diisi nol (register -1 = xzr).
+        auto valueInto = [&](int i, int reg) {
+            if (i >= n) return -1;
+            std::string r = "x" + std::to_string(reg);
+            if (simple) genSimpleInto(values[i], r);
+            else emit("  ldr " + r + ", [sp, #" + std::to_string(spDepth - pushedAt[i]) + "]");
+            return reg;
+        };
+
+        for (size_t i = 0; i < slots.size(); ++i) {
+            const FieldLayout& f = slots[i];
+            if (isAggregate(f.type)) {
+                if ((int)i >= n) continue;
+                valueInto((int)i, 1);
+                emitCopy("x0", f.offset, "x1", 0, f.size);
+                continue;
+            }
+            bool pair = i + 1 < slots.size() && f.size == 8 && slots[i + 1].size == 8 && !isAggregate(slots[i + 1].type)
+                        && slots[i + 1].offset == f.offset + 8 && f.offset % 8 == 0 && f.offset <= 504;
+            if (pair) {
+                int r1 = valueInto((int)i, 1);
+                int r2 = valueInto((int)i + 1, 2);
+                emit("  stp " + std::string(r1 < 0 ? "xzr" : "x1") + ", " + (r2 < 0 ? "xzr" : "x2") + ", [x0, #" + std::to_string(f.offset) + "]");
+                ++i;
+                continue;
+            }
+            emitStore(f.type, valueInto((int)i, 1), AddrMode{"x0", "", 0, f.offset});
+        }
+        if (!simple) {
+            emitAddImm("sp", "sp", 16 * n);
+            spDepth -= 16 * n;
+        }
+    }
+
+    void emitAddressOf(const std::string& reg, const std::string& label) {
+        emit("  adrp " + reg + ", " + label);
+        emit("  add " + reg + ", " + reg + ", :lo12:" + label);
+    }
+
+    // Tulis nilai konstan expr (bertipe type) ke out[off..]; false jika tidak konstan.
+    bool constImage(const NodePtr& expr, TypeId type, std::vector<uint8_t>& out, int off) {
+        TypeId t = types.canonical(type);
+        if (t == NoType) return false;
+        bool negate = false;
+        NodePtr e = expr;
+        if (auto u = std::dynamic_pointer_cast<UnaryOpNode>(e)) {
+            if (u->op != "-") return false;
+            negate = true;
+            e = u->rhs;
+        }
+        if (auto lit = std::dynamic_pointer_cast<LiteralNode>(e)) {
+            if (isAggregate(t) || types.kind(t) == TypeKind::Str) return false;
+            uint64_t v;
+            if (lit->value == "true") v = 1;
+            else if (lit->value == "false") v = 0;
+            else if (isdigit(lit->value[0])) v = std::stoull(lit->value, nullptr, 0);
+            else return false;
+            if (negate) v = (uint64_t)0 - v;
+            int size = layouts.sizeOf(t);
+            for (int i = 0; i < size; ++i) out[off + i] = (uint8_t)(v >> (8 * i));
+            return true;
+        }
+        if (negate) return false;
+        if (auto s = std::dynamic_pointer_cast<StructInitNode>(e)) {
+            if (!types.isStruct(t) || !types.same(s->resolvedType, t)) return false;
+            const StructLayout& layout = layouts.layoutOf(t);
+            if (s->args.size() > layout.fields.size()) return false;
+            for (size_t i = 0; i < s->args.size(); ++i) {
+                if (!constImage(s->args[i], layout.fields[i].type, out, off + layout.fields[i].offset)) return false;
+            }
+            return true;
+        }
+        if (auto arr = std::dynamic_pointer_cast<ArrayLiteralNode>(e)) {
+            TypeId elem = elementType(t);
+            if (elem == NoType || types.isPointer(t)) return false;
+            int stride = strideOf(elem);
+            if ((size_t)off + arr->elements.size() * stride > out.size()) return false;
+            for (size_t i = 0; i < arr->elements.size(); ++i) {
+                if (!constImage(arr->elements[i], elem, out, off + (int)i * stride)) return false;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // Literal struct/array yang seluruhnya konstan ditaruh di .rodata; x0 = alamatnya.
+    bool genConstLiteral(const NodePtr& expr, TypeId type) {
+        if (expr->kind != NodeKind::StructInit && expr->kind != NodeKind::ArrayLiteral) return false;
+        TypeId t = types.canonical(type);
+        if (t == NoType) return false;
+        int size, align;
+        if (expr->kind == NodeKind::ArrayLiteral && types.kind(t) == TypeKind::Slice) {
+            TypeId elem = elementType(t);
+            size = (int)std::dynamic_pointer_cast<ArrayLiteralNode>(expr)->elements.size() * strideOf(elem);
+            align = layouts.alignOf(elem);
+        } else {
+            if (!isAggregate(t)) return false;
+            size = layouts.sizeOf(t);
+            align = layouts.alignOf(t);
+        }
+        std::vector<uint8_t> bytes(size, 0);
+        if (size == 0 || !constImage(expr, t, bytes, 0)) return false;
+        emitAddressOf("x0", rodata.internBlob(bytes, align));
+        return true;
+    }
+
+    // Lokal yang ditulis lewat field/elemen, diambil alamatnya, atau bocor
+    // ke luar (argumen, return, alias) tidak boleh menunjuk ke .rodata.
+    static int rootLocal(const NodePtr& expr) {
+        if (auto v = std::dynamic_pointer_cast<VarRefNode>(expr)) return v->local;
+        if (auto m = std::dynamic_pointer_cast<MemberAccessNode>(expr)) return rootLocal(m->object);
+        if (auto ai = std::dynamic_pointer_cast<ArrayIndexNode>(expr)) return rootLocal(ai->array);
+        return -1;
     }
 
-    void gen(const NodePtr& node) {
+    void scanWrites(const NodePtr& node, bool readBase) {
+        if (!node) return;
         switch (node->kind) {
-            case NodeKind::StructDef:
-                genStruct(std::dynamic_pointer_cast<StructDefNode>(node)); break;
-            case NodeKind::FunctionDef:
-                genFunction(std::dynamic_pointer_cast<FunctionDefNode>(node)); break;
+            case NodeKind::VarRef:
+                if (!readBase) writtenLocals.insert(std::dynamic_pointer_cast<VarRefNode>(node)->local);
+                break;
+            case NodeKind::MemberAccess:
+                scanWrites(std::dynamic_pointer_cast<MemberAccessNode>(node)->object, true);
+                break;
+            case NodeKind::ArrayIndex: {
+                auto ai = std::dynamic_pointer_cast<ArrayIndexNode>(node);
+                scanWrites(ai->array, true);
+                scanWrites(ai->index, false);
+                break;
+            }
+            case NodeKind::UnaryOp: {
+                auto u = std::dynamic_pointer_cast<UnaryOpNode>(node);
+                if (u->op == "&") writtenLocals.insert(rootLocal(u->rhs));
+                scanWrites(u->rhs, u->op == "*");
+                break;
+            }
+            case NodeKind::BinaryOp: {
+                auto b = std::dynamic_pointer_cast<BinaryOpNode>(node);
+                scanWrites(b->lhs, false);
+                scanWrites(b->rhs, false);
+                break;
+            }
+            case NodeKind::Call:
+                for (auto& arg : std::dynamic_pointer_cast<CallNode>(node)->args) scanWrites(arg, false);
+                break;
+            case NodeKind::StructInit:
+                for (auto& arg : std::dynamic_pointer_cast<StructInitNode>(node)->args) scanWrites(arg, false);
+                break;
+            case NodeKind::ArrayLiteral:
+                for (auto& el : std::dynamic_pointer_cast<ArrayLiteralNode>(node)->elements) scanWrites(el, false);
+                break;
+            case NodeKind::Block:
+                for (auto& s : std::dynamic_pointer_cast<BlockNode>(node)->statements) scanWrites(s, false);
+                break;
+            case NodeKind::Decl: {
+                auto d = std::dynamic_pointer_cast<DeclStmtNode>(node);
+                localTypes[d->local] = d->type;
+                // Deklarasi agregat dari variabel lain menyalin isinya (hanya baca).
+                scanWrites(d->expr, isAggregate(d->type) && d->expr->kind == NodeKind::VarRef);
+                break;
+            }
+            case NodeKind::Assign: {
+                auto a = std::dynamic_pointer_cast<AssignStmtNode>(node);
+                if (a->lhs->kind == NodeKind::VarRef) {
+                    auto v = std::dynamic_pointer_cast<VarRefNode>(a->lhs);
+                    if (isAggregate(localTypes.count(v->local) ? localTypes[v->local] : NoType)) writtenLocals.insert(v->local);
+                } else {
+                    writtenLocals.insert(rootLocal(a->lhs));
+                    scanWrites(a->lhs, true);
+                }
+                scanWrites(a->expr, false);
+                break;
+            }
+            case NodeKind::PointerAssign: {
+                auto p = std::dynamic_pointer_cast<PointerAssignNode>(node);
+                scanWrites(p->pointerExpr, false);
+                scanWrites(p->valueExpr, false);
+                break;
+            }
+            case NodeKind::ExprStmt:
+                scanWrites(std::dynamic_pointer_cast<ExprStmtNode>(node)->expr, false);
+                break;
+            case NodeKind::Return:
+                scanWrites(std::dynamic_pointer_cast<ReturnStmtNode>(node)->expr, false);
+                break;
+            case NodeKind::If: {
+                auto i = std::dynamic_pointer_cast<IfStmtNode>(node);
+                for (auto& [cond, blk] : i->branches) {
+                    scanWrites(cond, false);
+                    scanWrites(blk, false);
+                }
+                scanWrites(i->elseBlock, false);
+                break;
+            }
+            case NodeKind::While: {
+                auto w = std::dynamic_pointer_cast<WhileStmtNode>(node);
+                scanWrites(w->cond, false);
+                scanWrites(w->block, false);
+                break;
+            }
+            case NodeKind::Inj:
+                for (auto& v : std::dynamic_pointer_cast<InjStmtNode>(node)->values) scanWrites(v, false);
+                break;
             default: break;
         }
     }
 
-    void genStruct(const std::shared_ptr<StructDefNode>& def) {
-        StructLayout layout;
-        int offset = 0;
-        for (auto& field : def->fields) {
-            layout.fieldOffsets[field.first] = offset;
-            offset += 8;
+    void genStructInit(const std::shared_ptr<StructInitNode>& s) {
+        const StructLayout& layout = layouts.layoutOf(s->resolvedType);
+        if (s->args.size() > layout.fields.size()) {
+            throw std::runtime_error("Too many initializers for struct '" + s->name + "' at line " + std::to_string(s->line));
+        }
+        genAggregateInit(s->args, layout.fields, layout.size, layout.align);
+    }
+
+    void genArrayLiteral(const std::shared_ptr<ArrayLiteralNode>& arr, TypeId elemType, int count = 0) {
+        TypeId elem = elemType == NoType ? types.U64 : elemType;
+        int stride = strideOf(elem);
+        std::vector<FieldLayout> slots;
+        for (size_t i = 0; i < std::max(arr->elements.size(), (size_t)count); ++i) {
+            FieldLayout f;
+            f.type = elem;
+            f.size = layouts.sizeOf(elem);
+            f.offset = (int)i * stride;
+            slots.push_back(f);
+        }
+        genAggregateInit(arr->elements, slots, (int)slots.size() * stride, layouts.alignOf(elem));
+    }
+
+    // Seperti genExpr, tetapi literal array memakai tipe elemen yang diharapkan
+    // dan literal untuk vektor diisikan ke semua lane.
+    void genExprAs(const NodePtr& expr, TypeId expectedType) {
+        if (types.isVector(expectedType) && !types.isVector(typeOf(expr))) {
+            genVectorTemp(expr, expectedType);
+        } else if (expr->kind == NodeKind::ArrayLiteral) {
+            genArrayLiteral(std::dynamic_pointer_cast<ArrayLiteralNode>(expr), elementType(expectedType));
+        } else {
+            genExpr(expr);
+        }
+    }
+
+    // Simpan x0 ke lvalue anggota/elemen; agregat disalin dengan ldp/stp.
+    void genStoreTo(const NodePtr& lhs) {
+        bool keep = !hasCall(lhs);
+        if (keep) emit("  mov x3, x0");
+        else push("x0");
+        TypeId type;
+        AddrMode a = genAddress(lhs, type);
+        if (!keep) pop("x3");
+        if (isAggregate(type)) {
+            if (!a.index.empty()) materialize(a);
+            emitCopy(a.base, a.offset, "x3", 0, layouts.sizeOf(type));
+        } else {
+            emitStore(type, 3, a);
+        }
+    }
+
+    // Lokal tinggal di frame ([x29, #off]) atau, di fungsi leaf, di register.
+    bool hasLocal(int local) const { return localOffsets.count(local) || localRegs.count(local); }
+
+    // Agregat inline: nilainya adalah alamat slot; selain itu slot selebar tipenya.
+    void loadLocal(const std::string& reg, int local) {
+        auto r = localRegs.find(local);
+        if (r != localRegs.end()) {
+            if (r->second != reg) emit("  mov " + reg + ", " + r->second);
+        } else if (inlineLocals.count(local)) {
+            emitAddImm(reg, "x29", localOffsets[local]);
+        } else {
+            emitLoad(slotType(local), std::stoi(reg.substr(1)), AddrMode{"x29", "", 0, localOffsets[local]});
+        }
+    }
+
+    void storeLocal(const std::string& reg, int local) {
+        auto r = localRegs.find(local);
+        if (r == localRegs.end()) emitStore(slotType(local), std::stoi(reg.substr(1)), AddrMode{"x29", "", 0, localOffsets[local]});
+        else emitNarrow(slotType(local), r->second, reg);
+    }
+
+    // Lokal di register berperilaku seperti slot selebar tipenya: nilai
+    // dipotong lalu di-extend persis seperti str + ldr ke frame.
+    void emitNarrow(TypeId type, const std::string& dst, const std::string& src) {
+        std::string wd = "w" + dst.substr(1), ws = "w" + src.substr(1);
+        bool sgn = layouts.isSigned(type);
+        switch (type == NoType ? 8 : layouts.sizeOf(type)) {
+            case 1: emit(sgn ? "  sxtb " + dst + ", " + ws : "  uxtb " + wd + ", " + ws); break;
+            case 2: emit(sgn ? "  sxth " + dst + ", " + ws : "  uxth " + wd + ", " + ws); break;
+            case 4: emit(sgn ? "  sxtw " + dst + ", " + ws : "  mov " + wd + ", " + ws); break;
+            default: if (dst != src) emit("  mov " + dst + ", " + src);
+        }
+    }
+
+    // Tipe isi slot frame; agregat yang bukan inline (parameter, literal
+    // konstan) disimpan sebagai pointer.
+    TypeId slotType(int local) {
+        auto it = localTypes.find(local);
+        if (it == localTypes.end() || it->second == NoType || isAggregate(it->second)) return NoType;
+        return it->second;
+    }
+
+    int allocSlot(int local) {
+        TypeId t = slotType(local);
+        int size = t == NoType ? 8 : layouts.sizeOf(t);
+        return localOffsets[local] = allocFrame(size, t == NoType ? 8 : layouts.alignOf(t));
+    }
+
+    // Argumen ke x0..xn. Argumen kompleks dihitung berurutan dan di-spill
+    // (kecuali yang terakhir) supaya tidak saling menimpa; literal dan lokal
+    // yang alamatnya tidak diambil dimuat paling akhir langsung ke registernya.
+    void genCallArgs(const std::shared_ptr<CallNode>& call) {
+        auto& args = call->args;
+        auto deferred = [&](const NodePtr& a) { return isStable(a); };
+        std::vector<size_t> complex;
+        for (size_t i = 0; i < args.size(); ++i) if (!deferred(args[i])) complex.push_back(i);
+
+        std::vector<int> pushedAt(args.size(), 0);
+        for (size_t k = 0; k < complex.size(); ++k) {
+            genExpr(args[complex[k]]);
+            if (k + 1 < complex.size()) {
+                push("x0");
+                pushedAt[complex[k]] = spDepth;
+            }
+        }
+        if (!complex.empty() && complex.back() != 0) emit("  mov x" + std::to_string(complex.back()) + ", x0");
+        if (complex.size() > 1) {
+            int base = spDepth;
+            for (size_t k = 0; k + 1 < complex.size(); ++k) {
+                size_t i = complex[k];
+                emit("  ldr x" + std::to_string(i) + ", [sp, #" + std::to_string(base - pushedAt[i]) + "]");
+            }
+            int bytes = 16 * (int)(complex.size() - 1);
+            emitAddImm("sp", "sp", bytes);
+            spDepth -= bytes;
+        }
+        for (size_t i = 0; i < args.size(); ++i) {
+            if (deferred(args[i])) genSimpleInto(args[i], "x" + std::to_string(i));
+        }
+    }
+
+    // Kembalikan sp, x29, x30 dan register basis MMIO seperti saat masuk.
+    void emitFrameTeardown() {
+        if (leafFrame) return;
+        emit("  mov sp, x29");
+        emit("  ldp x29, x30, [sp], #16");
+        size_t saved = mmioRegs.size();
+        if (saved % 2) emit("  ldr " + mmioRegs[saved - 1].second + ", [sp], #16");
+        for (size_t i = saved - saved % 2; i >= 2; i -= 2) {
+            emit("  ldp " + mmioRegs[i - 2].second + ", " + mmioRegs[i - 1].second + ", [sp], #16");
+        }
+    }
+
+    // calls: ada bl atau alokasi stack; escapes: alamat di dalam frame bisa
+    // keluar dari fungsi (sehingga frame harus hidup sampai callee selesai).
+    void scanFrame(const NodePtr& node, bool& calls, bool& escapes) {
+        switch (node->kind) {
+            case NodeKind::Call:
+                // Intrinsik tidak memanggil apa pun; yang bernilai vektor butuh temporer di frame.
+                if (!std::static_pointer_cast<CallNode>(node)->builtin) {
+                    calls = true;
+                } else if (types.isVector(node->resolvedType)) {
+                    calls = true;
+                    escapes = true;
+                }
+                break;
+            case NodeKind::BinaryOp:
+                if (types.isVector(node->resolvedType)) {
+                    calls = true;
+                    escapes = true;
+                }
+                break;
+            case NodeKind::StructInit:
+            case NodeKind::ArrayLiteral:
+            case NodeKind::Inj:
+                calls = true;
+                escapes = true;
+                break;
+            case NodeKind::Decl:
+                if (isAggregate(std::dynamic_pointer_cast<DeclStmtNode>(node)->type)) {
+                    calls = true;
+                    escapes = true;
+                }
+                break;
+            case NodeKind::Return: {
+                // Literal yang dikembalikan sebagai vektor diisikan ke temporer.
+                auto r = std::dynamic_pointer_cast<ReturnStmtNode>(node);
+                if (r->expr && r->expr->kind == NodeKind::Literal && types.isVector(functionTypes[functionName])) {
+                    calls = true;
+                    escapes = true;
+                }
+                break;
+            }
+            case NodeKind::UnaryOp: {
+                auto u = std::dynamic_pointer_cast<UnaryOpNode>(node);
+                if (u->op == "&") {
+                    int root = rootLocal(u->rhs);
+                    if (root >= 0) {
+                        addressTaken.insert(root);
+                        escapes = true;
+                    }
+                }
+                break;
+            }
+            default: break;
         }
-        layout.size = offset;
-        structLayouts[def->name] = layout;
+        visitChildren(node, [&](const NodePtr& c) { scanFrame(c, calls, escapes); });
     }
 
     void genFunction(const std::shared_ptr<FunctionDefNode>& fn) {
         localOffsets.clear();
-        currentOffset = 0;
+        localRegs.clear();
+        inlineLocals.clear();
+        frameTop = frameSize = 0;
+        localStringLiterals.clear();
+        addressTaken.clear();
+        remarks.clear();
+        spDepth = 0;
+        labelCount = 0;
+        functionName = fn->name;
+
+        epilogueLabel = ".L" + fn->name + "_ret";
+        localTypes.clear();
+        for (auto& param : fn->params) localTypes[param.local] = param.type;
+        mmioRegs.clear();
+        collectMmio(fn->body);
+
+        // Struct lokal yang tidak bocor jadi skalar sebelum kebutuhan frame dihitung.
+        ScalarReplacement sra(layouts);
+        sra.run(*fn);
+        functionSra = sra.split;
+
+        bool calls = false, escapes = false;
+        scanFrame(fn->body, calls, escapes);
+        tailCalls = !escapes;
+
+        // Leaf tanpa kebutuhan stack: parameter, lokal dan basis MMIO di register
+        // caller-saved yang tidak dipakai codegen, tanpa prolog/epilog.
+        static const char* homes[] = {"x9", "x10", "x11", "x12", "x13", "x4", "x5", "x6", "x7", "x8"};
+        const int homeCount = sizeof(homes) / sizeof(homes[0]);
+
+        // Temporer CSE di fungsi leaf hanya memakai register home yang tersisa,
+        // supaya fungsi tidak kehilangan status leaf.
+        int spareHomes = homeCount - std::max(fn->localCount, (int)fn->params.size()) - (int)mmioRegs.size();
+        bool leafShape = !calls && !escapes && fn->params.size() <= 8 && spareHomes >= 0;
+        CommonSubexpressions cse(types, addressTaken, leafShape, leafShape ? spareHomes : 1 << 20);
+        cse.run(*fn);
+        functionCse = cse.eliminated;
+
+        leafFrame = !calls && !escapes && fn->params.size() <= 8 &&
+                    std::max(fn->localCount, (int)fn->params.size()) + (int)mmioRegs.size() <= homeCount;
 
         emitLabel(fn->name);
-        emit("  stp x29, x30, [sp, #-16]!");
-        emit("  mov x29, sp");
+        if (leafFrame) {
+            int next = 0;
+            int argreg = 0;
+            for (auto& param : fn->params) {
+                localRegs[param.local] = homes[next++];
+                storeLocal("x" + std::to_string(argreg++), param.local);
+            }
+            for (int local = 0; local < fn->localCount; ++local) {
+                if (!localRegs.count(local)) localRegs[local] = homes[next++];
+            }
+            for (auto& entry : mmioRegs) entry.second = homes[next++];
+            for (auto& [name, reg] : mmioRegs) emitMovImm(reg, layouts.layoutOf(name).baseAddress);
+        } else {
+            for (size_t i = 0; i < mmioRegs.size(); i += 2) {
+                if (i + 1 < mmioRegs.size()) emit("  stp " + mmioRegs[i].second + ", " + mmioRegs[i + 1].second + ", [sp, #-16]!");
+                else emit("  str " + mmioRegs[i].second + ", [sp, #-16]!");
+            }
+            emit("  stp x29, x30, [sp, #-16]!");
+            emit("  mov x29, sp");
+            framePos = asmText.size();
+            // Basis blok register dimuat sekali per fungsi.
+            for (auto& [name, reg] : mmioRegs) emitMovImm(reg, layouts.layoutOf(name).baseAddress);
 
-        int argreg = 0;
-        for (auto& param : fn->params) {
-            currentOffset += 8;
-            localOffsets[param.name] = -currentOffset;
-            emit("  str x" + std::to_string(argreg++) + ", [x29, #" + std::to_string(-currentOffset) + "]");
+            int argreg = 0;
+            for (auto& param : fn->params) {
+                allocSlot(param.local);
+                storeLocal("x" + std::to_string(argreg++), param.local);
+            }
         }
+        writtenLocals.clear();
+        scanWrites(fn->body, false);
 
         genBlock(std::dynamic_pointer_cast<BlockNode>(fn->body));
 
-        emit("  ldp x29, x30, [sp], #16");
+        std::string jump = "  b " + epilogueLabel + "\n";
+        if (asmText.size() >= jump.size() && asmText.compare(asmText.size() - jump.size(), jump.size(), jump) == 0)
+            asmText.resize(asmText.size() - jump.size());
+        emitLabel(epilogueLabel);
+        emitFrameTeardown();
         emit("  ret");
+
+        // Ukuran frame baru diketahui setelah body; satu sub sp disisipkan
+        // setelah prolog. Push sementara selalu berada di bawahnya.
+        if (!leafFrame && frameSize > 0) {
+            std::string body = asmText.substr(framePos);
+            asmText.resize(framePos);
+            emitAddImm("sp", "sp", -LayoutEngine::alignUp(frameSize, 16));
+            asmText += body;
+        }
     }
 
     void genBlock(const std::shared_ptr<BlockNode>& block) {
-        for (auto& stmt : block->statements) genStmt(stmt);
+        auto& stmts = block->statements;
+        int scopeTop = frameTop;
+        for (size_t i = 0; i < stmts.size(); ++i) {
+            if (i + 1 < stmts.size() && genMmioPairStore(stmts[i], stmts[i + 1])) {
+                ++i;
+                continue;
+            }
+            int mark = frameTop;
+            genStmt(stmts[i]);
+            if (releasesTemps(stmts[i])) frameTop = mark;
+        }
+        frameTop = scopeTop;
+    }
+
+    // Temporer agregat statement ini mati setelahnya, kecuali alamatnya bisa
+    // tersimpan: deklarasi, atau penugasan nilai pointer/slice/str.
+    bool releasesTemps(const NodePtr& stmt) {
+        auto valueOnly = [&](TypeId t) {
+            return isAggregate(t) || types.isInteger(t) || types.kind(t) == TypeKind::Bool;
+        };
+        switch (stmt->kind) {
+            case NodeKind::Decl: return false;
+            case NodeKind::Assign: return valueOnly(typeOf(std::dynamic_pointer_cast<AssignStmtNode>(stmt)->lhs));
+            case NodeKind::PointerAssign: return valueOnly(typeOf(std::dynamic_pointer_cast<PointerAssignNode>(stmt)->valueExpr));
+            default: return true;
+        }
+    }
+
+    // Dua tulisan berurutan ke register MMIO bersebelahan (naik) -> satu stp.
+    bool genMmioPairStore(const NodePtr& first, const NodePtr& second) {
+        auto a = std::dynamic_pointer_cast<AssignStmtNode>(first);
+        auto b = std::dynamic_pointer_cast<AssignStmtNode>(second);
+        if (!a || !b || !isSimple(a->expr) || !isSimple(b->expr)) return false;
+        auto ma = std::dynamic_pointer_cast<MemberAccessNode>(a->lhs);
+        auto mb = std::dynamic_pointer_cast<MemberAccessNode>(b->lhs);
+        if (!ma || !mb || !isMmioRef(ma->object) || !isMmioRef(mb->object)) return false;
+        if (ma->object->resolvedType != mb->object->resolvedType) return false;
+        const FieldLayout* fa = fieldOf(ma);
+        const FieldLayout* fb = fieldOf(mb);
+        if (isAggregate(fa->type) || isAggregate(fb->type) || fa->size != fb->size) return false;
+        if ((fa->size != 4 && fa->size != 8) || fb->offset != fa->offset + fa->size) return false;
+        if (fa->offset % fa->size || fa->offset > 63 * fa->size) return false;
+
+        std::string base = mmioBaseReg(ma->object);
+        genSimpleInto(a->expr, "x1");
+        genSimpleInto(b->expr, "x2");
+        std::string w = fa->size == 8 ? "x" : "w";
+        emit("  stp " + w + "1, " + w + "2, [" + base + ", #" + std::to_string(fa->offset) + "]");
+        return true;
     }
 
     void genStmt(const NodePtr& stmt) {
@@ -120,22 +2075,65 @@ public:
             case NodeKind::Decl: {
                 auto d = std::dynamic_pointer_cast<DeclStmtNode>(stmt);
                 if (auto lit = std::dynamic_pointer_cast<LiteralNode>(d->expr)) {
-                    localStringLiterals[d->name] = lit->value;
+                    localStringLiterals[d->local] = lit->value;
+                }
+                bool constant = !writtenLocals.count(d->local) && !addressTaken.count(d->local) &&
+                                genConstLiteral(d->expr, d->type);
+                bool fresh = false;
+                if (!constant) {
+                    if (d->expr->kind == NodeKind::ArrayLiteral && types.isArray(d->type)) {
+                        // Elemen yang tidak ditulis di literal diisi nol.
+                        genArrayLiteral(std::dynamic_pointer_cast<ArrayLiteralNode>(d->expr), elementType(d->type),
+                                        (int)types.info(types.canonical(d->type)).count);
+                        fresh = true;
+                    } else {
+                        genExprAs(d->expr, d->type);
+                        fresh = d->expr->kind == NodeKind::StructInit || (types.isVector(d->type) && isVectorTemp(d->expr));
+                    }
+                }
+                localTypes[d->local] = d->type;
+                if (localRegs.count(d->local)) {
+                    storeLocal("x0", d->local);
+                } else if (isAggregate(d->type) && !constant) {
+                    // Agregat disimpan langsung di frame; temporer baru dipakai apa adanya.
+                    inlineLocals.insert(d->local);
+                    if (fresh) {
+                        localOffsets[d->local] = lastTemp;
+                    } else {
+                        int size = layouts.sizeOf(d->type);
+                        localOffsets[d->local] = allocFrame(size, layouts.alignOf(d->type));
+                        emit("  mov x1, x0");
+                        emitAddImm("x0", "x29", localOffsets[d->local]);
+                        emitCopy("x0", 0, "x1", 0, size);
+                    }
+                } else {
+                    allocSlot(d->local);
+                    storeLocal("x0", d->local);
                 }
-                genExpr(d->expr);
-                currentOffset += 8;
-                localOffsets[d->name] = -currentOffset;
-                emit("  str x0, [x29, #" + std::to_string(-currentOffset) + "]");
                 break;
             }
             case NodeKind::Assign: {
                 auto a = std::dynamic_pointer_cast<AssignStmtNode>(stmt);
-                genExpr(a->expr);
+                auto target = std::dynamic_pointer_cast<VarRefNode>(a->lhs);
+                if (target && types.isVector(typeOf(target)) && inlineLocals.count(target->local) && isVectorTemp(a->expr)) {
+                    // Hasil langsung ke slot lokal, tanpa temporer.
+                    genVectorInto(a->expr, 16, laneSize(typeOf(target)));
+                    emitVectorMem("str", 16, AddrMode{"x29", "", 0, localOffsets[target->local]});
+                    break;
+                }
+                genExprAs(a->expr, typeOf(a->lhs));
                 if (a->lhs->kind == NodeKind::VarRef) {
                     auto v = std::dynamic_pointer_cast<VarRefNode>(a->lhs);
-                    if (localOffsets.count(v->name)) {
-                        emit("  str x0, [x29, #" + std::to_string(localOffsets[v->name]) + "]");
+                    if (hasLocal(v->local)) {
+                        if (isAggregate(localTypes[v->local])) {
+                            loadLocal("x1", v->local);
+                            emitCopy("x1", 0, "x0", 0, layouts.sizeOf(localTypes[v->local]));
+                        } else {
+                            storeLocal("x0", v->local);
+                        }
                     }
+                } else if (a->lhs->kind == NodeKind::MemberAccess || a->lhs->kind == NodeKind::ArrayIndex) {
+                    genStoreTo(a->lhs);
                 }
                 break;
             }
@@ -144,7 +2142,7 @@ public:
                 genExpr(p->valueExpr);
                 emit("  mov x1, x0");
                 genExpr(p->pointerExpr);
-                emit("  str x1, [x0]");
+                emitStore(elementType(typeOf(p->pointerExpr)), 1, AddrMode{});
                 break;
             }
             case NodeKind::ExprStmt: {
@@ -153,8 +2151,20 @@ public:
             }
             case NodeKind::Return: {
                 auto r = std::dynamic_pointer_cast<ReturnStmtNode>(stmt);
-                if (r->expr) genExpr(r->expr);
-                emit("  ret"); break;
+                if (r->expr && tailCalls && r->expr->kind == NodeKind::Call) {
+                    auto call = std::dynamic_pointer_cast<CallNode>(r->expr);
+                    if (call->args.size() <= 8) {
+                        // Tail call: argumen disiapkan, frame dibongkar, lalu lompat;
+                        // callee kembali langsung ke pemanggil kita.
+                        genCallArgs(call);
+                        emitFrameTeardown();
+                        emit("  b " + call->name);
+                        break;
+                    }
+                }
+                if (r->expr && types.isVector(functionTypes[functionName])) genExprAs(r->expr, functionTypes[functionName]);
+                else if (r->expr) genExpr(r->expr);
+                emit("  b " + epilogueLabel); break;
             }
             case NodeKind::Break: {
                 if (!breakLabels.empty()) emit("  b " + breakLabels.top()); break;
@@ -164,14 +2174,14 @@ public:
             }
             case NodeKind::If: {
                 auto i = std::dynamic_pointer_cast<IfStmtNode>(stmt);
+                if (genSelect(i) || genSwitch(i)) break;
                 std::string endLabel = uniqueLabel("endif");
                 for (size_t j = 0; j < i->branches.size(); ++j) {
                     auto& [cond, blk] = i->branches[j];
                     std::string elseLabel = uniqueLabel("else");
-                    genExpr(cond);
-                    emit("  cbz x0, " + elseLabel);
+                    genBranch(cond, elseLabel, false);
                     genBlock(std::dynamic_pointer_cast<BlockNode>(blk));
-                    emit("  b " + endLabel);
+                    if (i->elseBlock || j + 1 < i->branches.size()) emit("  b " + endLabel);
                     emitLabel(elseLabel);
                 }
                 if (i->elseBlock) genBlock(std::dynamic_pointer_cast<BlockNode>(i->elseBlock));
@@ -180,15 +2190,26 @@ public:
             }
             case NodeKind::While: {
                 auto w = std::dynamic_pointer_cast<WhileStmtNode>(stmt);
+                VectorLoop plan;
+                std::string why = vectorPlan(w, plan);
+                if (why.empty()) {
+                    genVectorLoop(plan);
+                    remark(w, "loop vectorized (" + std::to_string(16 / plan.elemSize) + " x " +
+                                  (plan.elemSize == 1 ? "8" : "16") + "-bit lanes)");
+                } else {
+                    remark(w, "loop not vectorized: " + why);
+                }
+                // Kondisi di bawah body: satu branch per iterasi.
                 std::string begin = uniqueLabel("while_start");
+                std::string test = uniqueLabel("while_cond");
                 std::string end = uniqueLabel("while_end");
                 breakLabels.push(end);
-                continueLabels.push(begin);
+                continueLabels.push(test);
+                emit("  b " + test);
                 emitLabel(begin);
-                genExpr(w->cond);
-                emit("  cbz x0, " + end);
                 genBlock(std::dynamic_pointer_cast<BlockNode>(w->block));
-                emit("  b " + begin);
+                emitLabel(test);
+                genBranch(w->cond, begin, true);
                 emitLabel(end);
                 breakLabels.pop();
                 continueLabels.pop();
@@ -211,62 +2232,87 @@ public:
             case NodeKind::Literal: {
                 auto lit = std::dynamic_pointer_cast<LiteralNode>(expr);
                 if (isdigit(lit->value[0])) {
-                    emit("  mov x0, #" + lit->value);
+                    emitMovImm("x0", std::stoull(lit->value, nullptr, 0));
                 } else if (lit->value == "true") {
                     emit("  mov x0, #1");
                 } else if (lit->value == "false") {
                     emit("  mov x0, #0");
-                } else {
+                } else if (lit->value == "nil") {
                     emit("  mov x0, #0");
+                } else {
+                    emitAddressOf("x0", rodata.internString(lit->value));
                 }
                 break;
             }
             case NodeKind::VarRef: {
                 auto v = std::dynamic_pointer_cast<VarRefNode>(expr);
-                if (localOffsets.count(v->name))
-                    emit("  ldr x0, [x29, #" + std::to_string(localOffsets[v->name]) + "]");
+                if (hasLocal(v->local)) loadLocal("x0", v->local);
                 break;
             }
             case NodeKind::Call: {
                 auto call = std::dynamic_pointer_cast<CallNode>(expr);
-                for (size_t i = 0; i < call->args.size(); ++i) {
-                    genExpr(call->args[i]);
-                    emit("  mov x" + std::to_string(i) + ", x0");
+                if (call->builtin) {
+                    genIntrinsic(call);
+                    break;
                 }
+                genCallArgs(call);
                 emit("  bl " + call->name); break;
             }
-            case NodeKind::StructInit: {
-                auto s = std::dynamic_pointer_cast<StructInitNode>(expr);
-                auto layout = structLayouts[s->name];
-                emit("  mov x0, sp");
-                emit("  sub sp, sp, #" + std::to_string(layout.size));
+            case NodeKind::StructInit:
+                genStructInit(std::dynamic_pointer_cast<StructInitNode>(expr));
+                break;
+            case NodeKind::ArrayLiteral:
+                genArrayLiteral(std::dynamic_pointer_cast<ArrayLiteralNode>(expr), NoType);
+                break;
+            case NodeKind::MemberAccess:
+            case NodeKind::ArrayIndex: {
+                TypeId type;
+                AddrMode a = genAddress(expr, type);
+                if (isAggregate(type)) {
+                    std::string reg = materialize(a);
+                    if (reg != "x0") emit("  mov x0, " + reg);
+                } else {
+                    emitLoad(type, 0, a);
+                }
                 break;
             }
             case NodeKind::UnaryOp: {
                 auto un = std::dynamic_pointer_cast<UnaryOpNode>(expr);
+                if (un->op == "&") {
+                    if (auto v = std::dynamic_pointer_cast<VarRefNode>(un->rhs)) {
+                        if (localOffsets.count(v->local)) emitAddImm("x0", "x29", localOffsets[v->local]);
+                    } else if (un->rhs->kind == NodeKind::MemberAccess || un->rhs->kind == NodeKind::ArrayIndex) {
+                        TypeId type;
+                        AddrMode a = genAddress(un->rhs, type);
+                        std::string reg = materialize(a);
+                        if (reg != "x0") emit("  mov x0, " + reg);
+                    } else {
+                        genExpr(un->rhs);
+                    }
+                    break;
+                }
                 genExpr(un->rhs);
-                if (un->op == "*") emit("  ldr x0, [x0]");
+                if (un->op == "*") emitLoad(elementType(typeOf(un->rhs)), 0, AddrMode{});
                 else if (un->op == "-") emit("  neg x0, x0");
+                else if (un->op == "!") emit("  cmp x0, #0\n  cset x0, eq");
                 break;
             }
             case NodeKind::BinaryOp: {
                 auto bin = std::dynamic_pointer_cast<BinaryOpNode>(expr);
-                genExpr(bin->lhs);
-                emit("  mov x1, x0");
-                genExpr(bin->rhs);
-                if (bin->op == "+") emit("  add x0, x1, x0");
-                else if (bin->op == "-") emit("  sub x0, x1, x0");
-                else if (bin->op == "*") emit("  mul x0, x1, x0");
-                else if (bin->op == "/") emit("  udiv x0, x1, x0");
-                else if (bin->op == "%") {
-                    emit("  udiv x2, x1, x0");
-                    emit("  msub x0, x2, x0, x1");
-                } else if (bin->op == "==") emit("  cmp x1, x0\n  cset x0, eq");
-                else if (bin->op == "!=") emit("  cmp x1, x0\n  cset x0, ne");
-                else if (bin->op == "<") emit("  cmp x1, x0\n  cset x0, lt");
-                else if (bin->op == "<=") emit("  cmp x1, x0\n  cset x0, le");
-                else if (bin->op == ">") emit("  cmp x1, x0\n  cset x0, gt");
-                else if (bin->op == ">=") emit("  cmp x1, x0\n  cset x0, ge");
+                if (bin->op == "and" || bin->op == "or") {
+                    std::string falseLabel = uniqueLabel("false");
+                    std::string end = uniqueLabel("bool_end");
+                    genBranch(bin, falseLabel, false);
+                    emit("  mov x0, #1");
+                    emit("  b " + end);
+                    emitLabel(falseLabel);
+                    emit("  mov x0, #0");
+                    emitLabel(end);
+                    break;
+                }
+                if (types.isVector(typeOf(bin))) genVectorTemp(bin, typeOf(bin));
+                else if (isComparison(bin->op)) emit("  cset x0, " + genCompare(bin));
+                else genArith(bin);
                 break;
             }
             default: break;
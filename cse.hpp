@@ -0,0 +1,399 @@
+#ifndef CSE_HPP
+#define CSE_HPP
+
+#include "ast.hpp"
+#include "types.hpp"
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <algorithm>
+
+// Eliminasi subekspresi bersama per fungsi: value numbering berlingkup
+// dominator di atas AST. Ekspresi murni yang pasti sudah dihitung di jalur
+// yang sama (statement sebelumnya di blok ini atau blok luar) dipakai ulang
+// lewat lokal sementara __cseN, dideklarasikan tepat sebelum statement yang
+// pertama menghitungnya. Tulisan field/elemen/pointer, panggilan dan inj
+// menghapus nilai yang dibaca dari memori; assignment lokal menghapus nilai
+// yang memakai lokal itu. Akses MMIO (volatile) tidak pernah digabung.
+class CommonSubexpressions {
+    // Yang dibaca sebuah ekspresi, atau yang ditulis sebuah statement.
+    struct Deps {
+        std::set<int> locals;
+        bool memory = false;
+        bool all = false; // inj: semua lokal dan memori
+
+        void add(const Deps& o) {
+            locals.insert(o.locals.begin(), o.locals.end());
+            memory |= o.memory;
+            all |= o.all;
+        }
+    };
+
+    struct Value {
+        bool pure = false;
+        std::string key;
+        Deps deps;
+        int cost = 0; // perkiraan siklus untuk menghitung ulang
+        int size = 0; // jumlah node
+    };
+
+    struct Candidate {
+        NodePtr* original;
+        BlockNode* block;
+        size_t index; // statement di block yang pertama menghitungnya
+        std::vector<NodePtr*> uses;
+        Deps deps;
+        int cost;
+        int size;
+    };
+
+    // Posisi statement yang sedang ditelusuri.
+    struct Site {
+        BlockNode* block;
+        size_t index;
+        bool hoist;    // ekspresi di sini pasti dievaluasi: boleh jadi asal temporer
+        bool memory;   // statement tanpa panggilan: bacaan memori boleh digabung
+        const Deps* loop; // kondisi while: asal temporer harus invarian terhadap ini
+    };
+
+    TypeTable& types;
+    const std::unordered_set<int>& addressTaken;
+    bool registers; // temporer tinggal di register (fungsi leaf)
+    int budget;     // sisa temporer yang boleh dibuat
+
+    std::vector<Candidate> candidates;
+    std::unordered_map<std::string, size_t> available;
+
+public:
+    int eliminated = 0; // ekspresi yang diganti temporer
+
+    CommonSubexpressions(TypeTable& t, const std::unordered_set<int>& taken, bool inRegisters, int maxTemps)
+        : types(t), addressTaken(taken), registers(inRegisters), budget(maxTemps) {}
+
+    void run(FunctionDefNode& fn) {
+        // Tiap putaran memilih ekspresi terbesar dulu; subekspresi di dalam
+        // deklarasi temporer baru bisa digabung di putaran berikutnya.
+        for (int round = 0; round < 4 && budget > 0; ++round) {
+            candidates.clear();
+            available.clear();
+            walkBlock(static_cast<BlockNode*>(fn.body.get()));
+            if (!apply(fn)) break;
+        }
+    }
+
+private:
+    static bool intersects(const Deps& value, const Deps& kill) {
+        if (kill.all) return true;
+        if (value.memory && kill.memory) return true;
+        for (int l : value.locals) if (kill.locals.count(l)) return true;
+        return false;
+    }
+
+    void kill(const Deps& k) {
+        for (auto it = available.begin(); it != available.end();) {
+            if (intersects(candidates[it->second].deps, k)) it = available.erase(it);
+            else ++it;
+        }
+    }
+
+    // Panggilan dan literal agregat (mengalokasikan/menulis stack).
+    static bool clobbers(const NodePtr& n) {
+        if (!n) return false;
+        if (n->kind == NodeKind::Call || n->kind == NodeKind::StructInit || n->kind == NodeKind::ArrayLiteral) return true;
+        bool found = false;
+        visitChildren(n, [&](const NodePtr& c) { if (!found) found = clobbers(c); });
+        return found;
+    }
+
+    // Semua yang bisa ditulis oleh statement (beserta isinya).
+    Deps effects(const NodePtr& n) {
+        Deps d;
+        if (!n) return d;
+        switch (n->kind) {
+            case NodeKind::Decl:
+                d.locals.insert(static_cast<DeclStmtNode*>(n.get())->local);
+                break;
+            case NodeKind::Assign: {
+                auto a = static_cast<AssignStmtNode*>(n.get());
+                if (auto v = std::dynamic_pointer_cast<VarRefNode>(a->lhs)) {
+                    d.locals.insert(v->local);
+                    if (addressTaken.count(v->local) || types.isStruct(v->resolvedType) || types.isArray(v->resolvedType) ||
+                        types.isVector(v->resolvedType))
+                        d.memory = true;
+                } else {
+                    d.memory = true;
+                }
+                break;
+            }
+            case NodeKind::PointerAssign:
+            case NodeKind::Call:
+            case NodeKind::StructInit:
+            case NodeKind::ArrayLiteral:
+                d.memory = true;
+                break;
+            case NodeKind::Inj:
+                d.all = true;
+                break;
+            default: break;
+        }
+        visitChildren(n, [&](const NodePtr& c) { d.add(effects(c)); });
+        return d;
+    }
+
+    void walkBlock(BlockNode* block) {
+        for (size_t i = 0; i < block->statements.size(); ++i) walkStmt(block, i);
+    }
+
+    // Blok bersarang melihat nilai dari luar; nilai yang dibuat di dalamnya
+    // tidak tersedia lagi setelah blok selesai.
+    void walkNested(const NodePtr& blk) {
+        if (!blk) return;
+        auto saved = available;
+        walkBlock(static_cast<BlockNode*>(blk.get()));
+        available = std::move(saved);
+    }
+
+    void walkStmt(BlockNode* block, size_t index) {
+        NodePtr& stmt = block->statements[index];
+        Site site{block, index, true, !clobbers(stmt), nullptr};
+        switch (stmt->kind) {
+            case NodeKind::Decl:
+                walkExpr(static_cast<DeclStmtNode*>(stmt.get())->expr, site, false);
+                break;
+            case NodeKind::Assign: {
+                auto a = static_cast<AssignStmtNode*>(stmt.get());
+                walkExpr(a->expr, site, false);
+                // Target simpan bukan bacaan; yang dibaca hanya basis dan indeksnya.
+                if (auto m = std::dynamic_pointer_cast<MemberAccessNode>(a->lhs)) {
+                    walkExpr(m->object, site, false);
+                } else if (auto ai = std::dynamic_pointer_cast<ArrayIndexNode>(a->lhs)) {
+                    walkExpr(ai->array, site, false);
+                    walkExpr(ai->index, site, false);
+                }
+                break;
+            }
+            case NodeKind::PointerAssign: {
+                auto p = static_cast<PointerAssignNode*>(stmt.get());
+                walkExpr(p->valueExpr, site, false);
+                walkExpr(p->pointerExpr, site, false);
+                break;
+            }
+            case NodeKind::ExprStmt:
+                walkExpr(static_cast<ExprStmtNode*>(stmt.get())->expr, site, false);
+                break;
+            case NodeKind::Return:
+                walkExpr(static_cast<ReturnStmtNode*>(stmt.get())->expr, site, false);
+                break;
+            case NodeKind::If: {
+                auto i = static_cast<IfStmtNode*>(stmt.get());
+                for (size_t j = 0; j < i->branches.size(); ++j) {
+                    // Hanya kondisi pertama yang pasti dievaluasi.
+                    Site cond{block, index, j == 0, !clobbers(i->branches[j].first), nullptr};
+                    walkExpr(i->branches[j].first, cond, false);
+                    if (!cond.memory) kill(effects(i->branches[j].first));
+                    walkNested(i->branches[j].second);
+                }
+                walkNested(i->elseBlock);
+                break;
+            }
+            case NodeKind::While: {
+                auto w = static_cast<WhileStmtNode*>(stmt.get());
+                // Iterasi berikutnya melihat tulisan body: yang dipakai di dalam
+                // loop hanya nilai yang tidak ditulis loop. Kondisi dievaluasi
+                // minimal sekali, jadi nilai invariannya boleh dihitung sebelum loop.
+                Deps loopKills = effects(stmt);
+                kill(loopKills);
+                Site cond{block, index, true, !clobbers(w->cond), &loopKills};
+                walkExpr(w->cond, cond, false);
+                walkNested(w->block);
+                break;
+            }
+            default: break;
+        }
+        kill(effects(stmt));
+    }
+
+    bool candidateKind(const NodePtr& n) {
+        switch (n->kind) {
+            case NodeKind::MemberAccess:
+            case NodeKind::ArrayIndex:
+                return true;
+            case NodeKind::UnaryOp: {
+                const std::string& op = static_cast<UnaryOpNode*>(n.get())->op;
+                return op == "*" || op == "-";
+            }
+            case NodeKind::BinaryOp: {
+                const std::string& op = static_cast<BinaryOpNode*>(n.get())->op;
+                return op == "+" || op == "-" || op == "*" || op == "/" || op == "%";
+            }
+            default: return false;
+        }
+    }
+
+    // Kunjungi pasca-urut; conditional: bagian kanan and/or (belum tentu dievaluasi).
+    Value walkExpr(NodePtr& slot, const Site& site, bool conditional) {
+        Value v;
+        if (!slot) return v;
+        Node* n = slot.get();
+        v.size = 1;
+        auto child = [&](NodePtr& c, bool cond) {
+            Value cv = walkExpr(c, site, cond);
+            v.pure = v.pure && cv.pure;
+            v.deps.add(cv.deps);
+            v.cost += cv.cost;
+            v.size += cv.size;
+            return cv;
+        };
+        std::string tag = std::to_string(n->resolvedType);
+        switch (n->kind) {
+            case NodeKind::Literal:
+                v.pure = true;
+                v.key = "L" + tag + ":" + static_cast<LiteralNode*>(n)->value;
+                return v;
+            case NodeKind::VarRef: {
+                auto r = static_cast<VarRefNode*>(n);
+                if (r->local < 0 || n->isVolatile) return v;
+                v.pure = true;
+                v.key = "V" + std::to_string(r->local);
+                v.deps.locals.insert(r->local);
+                // Lokal yang alamatnya diambil bisa diubah lewat pointer.
+                if (addressTaken.count(r->local)) v.deps.memory = true;
+                v.cost = registers && !addressTaken.count(r->local) ? 0 : 4;
+                return v;
+            }
+            case NodeKind::BinaryOp: {
+                auto b = static_cast<BinaryOpNode*>(n);
+                v.pure = true;
+                Value l = child(b->lhs, conditional);
+                Value r = child(b->rhs, conditional || b->op == "and" || b->op == "or");
+                v.key = "B" + tag + b->op + "(" + l.key + "," + r.key + ")";
+                v.cost += b->op == "*" ? 3 : (b->op == "/" || b->op == "%") ? 12 : 1;
+                break;
+            }
+            case NodeKind::UnaryOp: {
+                auto u = static_cast<UnaryOpNode*>(n);
+                // &x: alamat, bukan nilai; isinya tidak boleh diganti temporer.
+                if (u->op == "&") return v;
+                v.pure = true;
+                Value r = child(u->rhs, conditional);
+                v.key = "U" + tag + u->op + "(" + r.key + ")";
+                if (u->op == "*") v.deps.memory = true;
+                v.cost += u->op == "*" ? 4 : 1;
+                break;
+            }
+            case NodeKind::MemberAccess: {
+                auto m = static_cast<MemberAccessNode*>(n);
+                v.pure = !n->isVolatile;
+                Value o = child(m->object, conditional);
+                v.key = "M" + tag + m->field + "(" + o.key + ")";
+                v.deps.memory = true;
+                v.cost += 4;
+                break;
+            }
+            case NodeKind::ArrayIndex: {
+                auto ai = static_cast<ArrayIndexNode*>(n);
+                v.pure = !n->isVolatile;
+                Value a = child(ai->array, conditional);
+                Value i = child(ai->index, conditional);
+                v.key = "A" + tag + "(" + a.key + "," + i.key + ")";
+                v.deps.memory = true;
+                v.cost += 4;
+                break;
+            }
+            case NodeKind::Call:
+                for (auto& arg : static_cast<CallNode*>(n)->args) walkExpr(arg, site, conditional);
+                return Value();
+            case NodeKind::StructInit:
+                for (auto& arg : static_cast<StructInitNode*>(n)->args) walkExpr(arg, site, conditional);
+                return Value();
+            case NodeKind::ArrayLiteral:
+                for (auto& el : static_cast<ArrayLiteralNode*>(n)->elements) walkExpr(el, site, conditional);
+                return Value();
+            default:
+                return Value();
+        }
+        if (v.pure) record(slot, v, site, conditional);
+        return v;
+    }
+
+    void record(NodePtr& slot, const Value& v, const Site& site, bool conditional) {
+        TypeId t = slot->resolvedType;
+        if (!candidateKind(slot) || !(types.isInteger(t) || types.isPointer(t))) return;
+        if (v.deps.locals.empty() && !v.deps.memory) return; // konstanta
+        if (v.deps.memory && !site.memory) return;
+
+        auto it = available.find(v.key);
+        if (it != available.end()) {
+            candidates[it->second].uses.push_back(&slot);
+            return;
+        }
+        if (!site.hoist || conditional) return;
+        if (site.loop && intersects(v.deps, *site.loop)) return;
+        available[v.key] = candidates.size();
+        candidates.push_back(Candidate{&slot, site.block, site.index, {}, v.deps, v.cost, v.size});
+    }
+
+    static void cover(const NodePtr& n, std::unordered_set<Node*>& covered) {
+        covered.insert(n.get());
+        visitChildren(n, [&](const NodePtr& c) { cover(c, covered); });
+    }
+
+    bool apply(FunctionDefNode& fn) {
+        std::vector<size_t> order(candidates.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return candidates[a].size > candidates[b].size;
+        });
+
+        // Temporer: simpan sekali (mov/str) lalu tiap pemakaian mov atau ldr.
+        int useCost = registers ? 0 : 4;
+        std::unordered_set<Node*> covered;
+        std::map<BlockNode*, std::multimap<size_t, NodePtr, std::greater<size_t>>> inserts;
+        for (size_t idx : order) {
+            Candidate& c = candidates[idx];
+            if (budget <= 0) break;
+            if (covered.count(c.original->get())) continue;
+            std::vector<NodePtr*> uses;
+            for (NodePtr* u : c.uses) if (!covered.count(u->get())) uses.push_back(u);
+            int n = (int)uses.size() + 1;
+            if (uses.empty() || (n - 1) * c.cost <= 1 + n * useCost) continue;
+
+            cover(*c.original, covered);
+            for (NodePtr* u : uses) cover(*u, covered);
+
+            NodePtr expr = *c.original;
+            TypeId type = expr->resolvedType;
+            int local = fn.localCount++;
+            std::string name = "__cse" + std::to_string(local);
+            // Slot selebar register: nilai dipakai ulang persis seperti dihitung.
+            auto decl = std::make_shared<DeclStmtNode>(name, types.isInteger(type) ? types.U64 : type, expr);
+            decl->local = local;
+            decl->line = expr->line;
+            decl->column = expr->column;
+            auto ref = [&](const NodePtr& at) {
+                auto r = std::make_shared<VarRefNode>(name, at->line);
+                r->column = at->column;
+                r->local = local;
+                r->resolvedType = type;
+                return r;
+            };
+            *c.original = ref(expr);
+            for (NodePtr* u : uses) *u = ref(*u);
+            inserts[c.block].emplace(c.index, decl);
+            eliminated += (int)uses.size();
+            --budget;
+        }
+
+        // Indeks besar dulu supaya indeks yang lebih kecil tetap berlaku.
+        for (auto& [block, decls] : inserts) {
+            for (auto& [index, decl] : decls) block->statements.insert(block->statements.begin() + index, decl);
+        }
+        return !inserts.empty();
+    }
+};
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef DAEMON_HPP
+#define DAEMON_HPP
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Mode daemon: satu proses quelang melayani kompilasi lewat Unix domain
+// socket dan menyimpan state hangat di antara request: modul @load yang sudah
+// dipraproses beserta hasil parse/cek-nya (frontend.hpp) dan cache assembly
+// per fungsi.
+// Request: cwd + argumen; respons: kode keluar + stdout + stderr.
+// Request dilayani satu per satu karena handler memakai chdir dan std::cout.
+namespace daemon_proto {
+
+inline void writeAll(int fd, const void* data, size_t n) {
+    auto p = static_cast<const char*>(data);
+    while (n > 0) {
+        ssize_t w = ::write(fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("socket write failed: ") + std::strerror(errno));
+        }
+        p += w;
+        n -= w;
+    }
+}
+
+inline void readAll(int fd, void* data, size_t n) {
+    auto p = static_cast<char*>(data);
+    while (n > 0) {
+        ssize_t r = ::read(fd, p, n);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) throw std::runtime_error("socket closed");
+        p += r;
+        n -= r;
+    }
+}
+
+inline void sendString(int fd, const std::string& s) {
+    uint32_t n = (uint32_t)s.size();
+    writeAll(fd, &n, sizeof n);
+    writeAll(fd, s.data(), s.size());
+}
+
+inline std::string recvString(int fd) {
+    uint32_t n = 0;
+    readAll(fd, &n, sizeof n);
+    if (n > (1u << 30)) throw std::runtime_error("bad daemon message");
+    std::string s(n, '\0');
+    readAll(fd, &s[0], n);
+    return s;
+}
+
+inline sockaddr_un address(const std::string& path) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof addr);
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof addr.sun_path) throw std::runtime_error("Socket path too long: " + path);
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+    return addr;
+}
+
+} // namespace daemon_proto
+
+// handler dijalankan dengan std::cout/std::cerr dialihkan ke respons.
+// Argumen tunggal "--shutdown" menghentikan daemon.
+inline int serveDaemon(const std::string& socketPath,
+                       const std::function<int(const std::vector<std::string>&)>& handler) {
+    using namespace daemon_proto;
+    std::signal(SIGPIPE, SIG_IGN);
+
+    int server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0) throw std::runtime_error(std::string("socket failed: ") + std::strerror(errno));
+    sockaddr_un addr = address(socketPath);
+    ::unlink(socketPath.c_str());
+    if (::bind(server, (sockaddr*)&addr, sizeof addr) != 0 || ::listen(server, 16) != 0) {
+        std::string err = std::strerror(errno);
+        ::close(server);
+        throw std::runtime_error("Cannot listen on " + socketPath + ": " + err);
+    }
+
+    std::cout << "quelang daemon listening on " << socketPath << std::endl;
+
+    bool running = true;
+    while (running) {
+        int client = ::accept(server, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        try {
+            std::string cwd = recvString(client);
+            uint32_t argc = 0;
+            readAll(client, &argc, sizeof argc);
+            std::vector<std::string> args;
+            for (uint32_t i = 0; i < argc; ++i) args.push_back(recvString(client));
+
+            int code = 0;
+            std::ostringstream out, err;
+            if (args.size() == 1 && args[0] == "--shutdown") {
+                out << "quelang daemon stopped\n";
+                running = false;
+            } else if (::chdir(cwd.c_str()) != 0) {
+                err << "Error: daemon cannot enter directory " << cwd << "\n";
+                code = 1;
+            } else {
+                auto* oldOut = std::cout.rdbuf(out.rdbuf());
+                auto* oldErr = std::cerr.rdbuf(err.rdbuf());
+                try {
+                    code = handler(args);
+                } catch (const std::exception& e) {
+                    std::cerr << "Error: " << e.what() << "\n";
+                    code = 1;
+                }
+                std::cout.flush();
+                std::cout.rdbuf(oldOut);
+                std::cerr.rdbuf(oldErr);
+            }
+            int32_t status = code;
+            writeAll(client, &status, sizeof status);
+            sendString(client, out.str());
+            sendString(client, err.str());
+        } catch (const std::exception& e) {
+            std::cerr << "quelang daemon: " << e.what() << "\n";
+        }
+        ::close(client);
+    }
+
+    ::close(server);
+    ::unlink(socketPath.c_str());
+    return 0;
+}
+
+// Client tipis: kirim argumen ke daemon, cetak keluarannya, pakai kode keluarnya.
+inline int runClient(const std::string& socketPath, const std::vector<std::string>& args) {
+    using namespace daemon_proto;
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) throw std::runtime_error(std::string("socket failed: ") + std::strerror(errno));
+    sockaddr_un addr = address(socketPath);
+    if (::connect(fd, (sockaddr*)&addr, sizeof addr) != 0) {
+        std::string err = std::strerror(errno);
+        ::close(fd);
+        throw std::runtime_error("Cannot connect to daemon at " + socketPath + ": " + err);
+    }
+
+    char cwd[PATH_MAX];
+    if (!::getcwd(cwd, sizeof cwd)) {
+        ::close(fd);
+        throw std::runtime_error("Cannot determine working directory");
+    }
+
+    int32_t status = 1;
+    std::string out, err;
+    try {
+        sendString(fd, cwd);
+        uint32_t argc = (uint32_t)args.size();
+        writeAll(fd, &argc, sizeof argc);
+        for (auto& a : args) sendString(fd, a);
+
+        readAll(fd, &status, sizeof status);
+        out = recvString(fd);
+        err = recvString(fd);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+
+    std::cout << out;
+    std::cerr << err;
+    return status;
+}
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef DIAGNOSTICS_HPP
+#define DIAGNOSTICS_HPP
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <stdexcept>
+
+// Error parser/checker dengan lokasi di sumber hasil link.
+struct CompileError : std::runtime_error {
+    std::string message;
+    int line;
+    int column;
+
+    CompileError(const std::string& msg, int l, int c = 0)
+        : std::runtime_error(msg + " at line " + std::to_string(l)), message(msg), line(l), column(c) {}
+};
+
+// Baris hasil link -> file dan baris asli; indent = spasi awal yang dibuang linker.
+struct SourceLoc {
+    std::string file;
+    int line = 0;
+    int indent = 0;
+};
+
+struct Diagnostic {
+    int line;
+    int column;
+    std::string message;
+};
+
+// Dilempar saat jumlah error mencapai --max-errors.
+struct TooManyErrors : std::exception {
+    const char* what() const noexcept override { return "too many errors"; }
+};
+
+class Diagnostics {
+    std::vector<Diagnostic> errors;
+    const std::vector<SourceLoc>* sourceMap;
+    int maxErrors;
+
+public:
+    // maxErrors = 0: tanpa batas.
+    explicit Diagnostics(int maxErrors = 20, const std::vector<SourceLoc>* map = nullptr)
+        : sourceMap(map), maxErrors(maxErrors) {}
+
+    void report(const CompileError& e) {
+        report({e.line, e.column, e.message});
+    }
+
+    void report(const Diagnostic& d) {
+        errors.push_back(d);
+        if (maxErrors > 0 && (int)errors.size() >= maxErrors) throw TooManyErrors();
+    }
+
+    void error(int line, int column, const std::string& message) {
+        report({line, column, message});
+    }
+
+    bool hasErrors() const { return !errors.empty(); }
+    size_t count() const { return errors.size(); }
+    const std::vector<Diagnostic>& list() const { return errors; }
+
+    void print(std::ostream& out) const {
+        for (auto& d : errors) print(out, d, "error");
+    }
+
+    // Satu pesan dengan lokasi asli; kind mis. "error" atau "remark".
+    void print(std::ostream& out, const Diagnostic& d, const char* kind) const {
+        if (sourceMap && d.line > 0 && d.line <= (int)sourceMap->size()) {
+            const SourceLoc& loc = (*sourceMap)[d.line - 1];
+            out << loc.file << ":" << loc.line << ":" << (d.column > 0 ? d.column + loc.indent : 0);
+        } else {
+            out << "<input>:" << d.line << ":" << d.column;
+        }
+        out << ": " << kind << ": " << d.message << "\n";
+    }
+};
+
+#endif
@@ -0,0 +1,248 @@
+#ifndef FNCACHE_HPP
+#define FNCACHE_HPP
+
+#include "ast.hpp"
+#include "layout.hpp"
+#include "rodata.hpp"
+#include "diagnostics.hpp"
+#include <string>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <fstream>
+#include <cstdio>
+#include <cstdint>
+
+// Sidik jari satu fungsi: bentuk AST-nya (dengan tipe hasil checker), layout
+// setiap tipe yang disentuh, dan signature fungsi yang dipanggil. Nomor baris
+// tidak ikut, jadi menggeser fungsi di file tidak membatalkan cache.
+class FunctionFingerprint {
+    LayoutEngine& layouts;
+    TypeTable& types;
+    const std::unordered_map<std::string, std::shared_ptr<FunctionDefNode>>& functions;
+    std::unordered_map<TypeId, uint64_t> typeHashes;
+    std::set<TypeId> inProgress;
+    std::string target; // fitur target yang mengubah kode (mis. "+lse")
+
+public:
+    FunctionFingerprint(LayoutEngine& l, const std::unordered_map<std::string, std::shared_ptr<FunctionDefNode>>& fns,
+                        const std::string& target = "")
+        : layouts(l), types(l.typeTable()), functions(fns), target(target) {}
+
+    uint64_t of(const std::shared_ptr<FunctionDefNode>& fn) {
+        uint64_t h = mix(mix(0, fn->name), target);
+        h = mix(h, typeHash(fn->returnType));
+        h = mix(h, (uint64_t)fn->localCount);
+        for (auto& p : fn->params) {
+            h = mix(h, p.name);
+            h = mix(h, typeHash(p.type));
+            h = mix(h, (uint64_t)p.local);
+        }
+        return node(h, fn->body);
+    }
+
+private:
+    uint64_t node(uint64_t h, const NodePtr& n) {
+        if (!n) return mix(h, (uint64_t)0xff);
+        h = mix(h, (uint64_t)n->kind);
+        h = mix(h, (uint64_t)n->isVolatile);
+        h = mix(h, typeHash(n->resolvedType));
+        switch (n->kind) {
+            case NodeKind::Decl: {
+                auto d = static_cast<DeclStmtNode*>(n.get());
+                h = mix(mix(mix(h, d->name), typeHash(d->type)), (uint64_t)d->local);
+                break;
+            }
+            case NodeKind::If: {
+                auto i = static_cast<IfStmtNode*>(n.get());
+                h = mix(mix(h, (uint64_t)i->branches.size()), (uint64_t)(i->elseBlock != nullptr));
+                break;
+            }
+            case NodeKind::Inj: h = mix(h, static_cast<InjStmtNode*>(n.get())->target); break;
+            case NodeKind::Literal: h = mix(h, static_cast<LiteralNode*>(n.get())->value); break;
+            case NodeKind::VarRef: {
+                auto v = static_cast<VarRefNode*>(n.get());
+                h = mix(mix(h, v->name), (uint64_t)v->local);
+                break;
+            }
+            case NodeKind::Call: {
+                auto c = static_cast<CallNode*>(n.get());
+                h = mix(h, c->name);
+                auto it = functions.find(c->name);
+                if (it != functions.end()) {
+                    h = mix(h, typeHash(it->second->returnType));
+                    for (auto& p : it->second->params) h = mix(h, typeHash(p.type));
+                }
+                break;
+            }
+            case NodeKind::StructInit: h = mix(h, static_cast<StructInitNode*>(n.get())->name); break;
+            case NodeKind::UnaryOp: h = mix(h, static_cast<UnaryOpNode*>(n.get())->op); break;
+            case NodeKind::BinaryOp: h = mix(h, static_cast<BinaryOpNode*>(n.get())->op); break;
+            case NodeKind::MemberAccess: h = mix(h, static_cast<MemberAccessNode*>(n.get())->field); break;
+            default: break;
+        }
+        // Penanda buka/tutup supaya struktur pohon tidak ambigu.
+        h = mix(h, (uint64_t)'(');
+        visitChildren(n, [&](const NodePtr& c) { h = node(h, c); });
+        return mix(h, (uint64_t)')');
+    }
+
+    uint64_t typeHash(TypeId type) {
+        if (type == NoType) return 0;
+        TypeId id = types.canonical(type);
+        auto it = typeHashes.find(id);
+        if (it != typeHashes.end()) return it->second;
+        const TypeInfo& t = types.info(id);
+        uint64_t h = mix(mix(0, t.name), (uint64_t)t.kind);
+        // Struct rekursif lewat pointer: cukup nama saat sedang dihitung.
+        if (!inProgress.insert(id).second) return h;
+        if (t.kind == TypeKind::Struct) {
+            const StructLayout& l = layouts.layoutOf(id);
+            h = mix(mix(mix(h, (uint64_t)l.size), (uint64_t)l.align), (uint64_t)l.packed);
+            h = mix(h, l.baseAddress);
+            for (auto& f : l.fields) {
+                h = mix(mix(h, f.name), (uint64_t)f.offset);
+                h = mix(h, typeHash(f.type));
+            }
+        } else if (t.elem != NoType) {
+            h = mix(mix(h, typeHash(t.elem)), (uint64_t)t.count);
+        }
+        inProgress.erase(id);
+        // Hasil yang terpotong siklus bergantung urutan kunjungan; jangan disimpan.
+        if (inProgress.empty()) typeHashes[id] = h;
+        return h;
+    }
+
+    static uint64_t mix(uint64_t h, const void* data, size_t n) {
+        if (!h) h = 1469598103934665603ULL;
+        auto p = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < n; ++i) {
+            h ^= p[i];
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    static uint64_t mix(uint64_t h, uint64_t v) { return mix(h, &v, sizeof v); }
+
+    static uint64_t mix(uint64_t h, const std::string& s) {
+        return mix(mix(h, (uint64_t)s.size()), s.data(), s.size());
+    }
+};
+
+// Cache assembly per fungsi di antara kompilasi (--cache FILE). Entri lama
+// dipakai jika sidik jarinya sama; file ditulis ulang hanya berisi fungsi
+// program sekarang. File yang rusak atau dari build compiler lain diabaikan.
+class FunctionCache {
+public:
+    struct Entry {
+        uint64_t fingerprint = 0;
+        std::string text;
+        RodataPool rodata;
+        int cse = 0;
+        int sra = 0;
+        std::vector<Diagnostic> remarks; // baris relatif terhadap baris 'def' fungsi
+    };
+
+private:
+    // Build compiler lain bisa menghasilkan kode lain untuk AST yang sama.
+    static constexpr const char* Version = "quelang-fncache 2 " __DATE__ " " __TIME__;
+
+    std::string path;
+    std::unordered_map<std::string, Entry> previous;
+    std::map<std::string, Entry> current;
+
+public:
+    int reused = 0;
+    int compiled = 0;
+
+    // Tanpa path: cache hanya di memori, mis. milik daemon.
+    FunctionCache() = default;
+
+    explicit FunctionCache(const std::string& p) : path(p) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return;
+        try {
+            load(in);
+        } catch (const std::exception&) {
+            previous.clear();
+        }
+    }
+
+    // Awal satu kompilasi.
+    void begin() {
+        current.clear();
+        reused = 0;
+        compiled = 0;
+    }
+
+    // Hanya dibaca selama codegen, aman dipanggil dari banyak worker.
+    const Entry* find(const std::string& name, uint64_t fingerprint) const {
+        auto it = previous.find(name);
+        if (it == previous.end() || it->second.fingerprint != fingerprint) return nullptr;
+        return &it->second;
+    }
+
+    void store(const std::string& name, Entry e) {
+        current[name] = std::move(e);
+    }
+
+    // Hasil kompilasi ini menjadi acuan kompilasi berikutnya. File ditulis ke
+    // file sementara lalu di-rename, supaya kompilasi yang terputus tidak
+    // meninggalkan cache setengah jadi.
+    void save() {
+        if (!path.empty()) writeFile();
+        previous.clear();
+        for (auto& [name, e] : current) previous[name] = std::move(e);
+        current.clear();
+    }
+
+private:
+    void writeFile() {
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out) throw std::runtime_error("Cannot write cache file: " + path);
+            out << Version << "\n";
+            for (auto& [name, e] : current) {
+                out << "F " << name << "\n" << std::hex << e.fingerprint << std::dec << " " << e.text.size() << "\n";
+                out.write(e.text.data(), e.text.size());
+                e.rodata.save(out);
+                out << e.cse << " " << e.sra << " " << e.remarks.size() << "\n";
+                for (auto& r : e.remarks) {
+                    out << r.line << " " << r.column << " " << r.message.size() << "\n";
+                    out.write(r.message.data(), r.message.size());
+                }
+            }
+            if (!out) throw std::runtime_error("Cannot write cache file: " + path);
+        }
+        if (std::rename(tmp.c_str(), path.c_str()) != 0) throw std::runtime_error("Cannot write cache file: " + path);
+    }
+
+    void load(std::istream& in) {
+        std::string line;
+        if (!std::getline(in, line) || line != Version) return;
+        while (in.peek() == 'F') {
+            std::string tag, name;
+            in >> tag >> name;
+            Entry e;
+            size_t n = 0;
+            if (!(in >> std::hex >> e.fingerprint >> std::dec >> n) || in.get() != '\n') throw std::runtime_error("bad cache entry");
+            e.text.resize(n);
+            if (!in.read(&e.text[0], n)) throw std::runtime_error("bad cache entry");
+            e.rodata.load(in);
+            size_t remarks = 0;
+            if (!(in >> e.cse >> e.sra >> remarks) || in.get() != '\n') throw std::runtime_error("bad cache entry");
+            for (size_t i = 0; i < remarks; ++i) {
+                Diagnostic r;
+                if (!(in >> r.line >> r.column >> n) || in.get() != '\n') throw std::runtime_error("bad cache entry");
+                r.message.resize(n);
+                if (!in.read(&r.message[0], n)) throw std::runtime_error("bad cache entry");
+                e.remarks.push_back(std::move(r));
+            }
+            previous[name] = std::move(e);
+        }
+    }
+};
+
+#endif
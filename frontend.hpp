@@ -0,0 +1,316 @@
+#ifndef FRONTEND_HPP
+#define FRONTEND_HPP
+
+#include "ast.hpp"
+#include "types.hpp"
+#include "linker.hpp"
+#include "diagnostics.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <unordered_map>
+
+// Butuh Parser dan Tokenizer (parser.cpp) yang di-include lebih dulu oleh main.cpp.
+
+// Hasil checker satu modul untuk satu antarmuka program. Id tipe menunjuk
+// tabel program tempat modul itu dicek.
+struct CheckedModule {
+    uint64_t interface = 0;
+    std::shared_ptr<const TypeTable> types;
+    std::vector<NodePtr> defs; // sejajar dengan ParsedModule::defs; baris lokal
+};
+
+// Hasil parse satu modul, tidak bergantung pada modul lain: id tipe menunjuk
+// tabel milik modul ini, baris = baris praproses modul (bukan baris link).
+struct ParsedModule {
+    std::shared_ptr<TypeTable> types;
+    std::vector<NodePtr> defs;
+    std::vector<uint64_t> interfaces; // per def: hash bagian yang terlihat modul lain (0: tidak ada)
+    std::vector<Diagnostic> errors;
+    std::mutex mutex; // menjaga checked
+    std::vector<std::shared_ptr<const CheckedModule>> checked; // terbaru di belakang
+};
+
+// Id tipe dari tabel lain ke tabel program: tipe bernama lewat namanya,
+// pointer/slice/array dibentuk ulang dari elemennya.
+class TypeImporter {
+    const TypeTable& from;
+    TypeTable& to;
+    std::unordered_map<TypeId, TypeId> done;
+
+public:
+    TypeImporter(const TypeTable& f, TypeTable& t) : from(f), to(t) {}
+
+    TypeId operator()(TypeId id) {
+        if (id == NoType) return NoType;
+        auto it = done.find(id);
+        if (it != done.end()) return it->second;
+        const TypeInfo& t = from.info(id);
+        TypeId r;
+        switch (t.kind) {
+            case TypeKind::Pointer: r = to.pointerTo((*this)(t.elem)); break;
+            case TypeKind::Slice: r = to.sliceOf((*this)(t.elem)); break;
+            case TypeKind::Array: r = to.arrayOf((*this)(t.elem), t.count); break;
+            default: r = to.named(t.name);
+        }
+        return done[id] = r;
+    }
+};
+
+// Salinan dalam satu pohon AST; type dan line memetakan id tipe dan baris.
+template<typename N>
+static NodePtr copyNode(const NodePtr& n) {
+    return std::make_shared<N>(static_cast<const N&>(*n));
+}
+
+template<typename TypeMap, typename LineMap>
+NodePtr copyTree(const NodePtr& n, TypeMap& type, LineMap& line) {
+    if (!n) return nullptr;
+    NodePtr c;
+    switch (n->kind) {
+        case NodeKind::FunctionDef: {
+            auto f = std::static_pointer_cast<FunctionDefNode>(copyNode<FunctionDefNode>(n));
+            f->returnType = type(f->returnType);
+            for (auto& p : f->params) {
+                p.type = type(p.type);
+                p.line = line(p.line);
+            }
+            c = f;
+            break;
+        }
+        case NodeKind::TypeInit: {
+            auto t = std::static_pointer_cast<TypeInitNode>(copyNode<TypeInitNode>(n));
+            t->type = type(t->type);
+            c = t;
+            break;
+        }
+        case NodeKind::StructDef: {
+            auto s = std::static_pointer_cast<StructDefNode>(copyNode<StructDefNode>(n));
+            s->id = type(s->id);
+            for (auto& f : s->fields) f.second = type(f.second);
+            for (auto& pos : s->fieldPos) pos.first = line(pos.first);
+            c = s;
+            break;
+        }
+        case NodeKind::Decl: {
+            auto d = std::static_pointer_cast<DeclStmtNode>(copyNode<DeclStmtNode>(n));
+            d->type = type(d->type);
+            c = d;
+            break;
+        }
+        case NodeKind::Program: c = copyNode<ProgramNode>(n); break;
+        case NodeKind::Block: c = copyNode<BlockNode>(n); break;
+        case NodeKind::Assign: c = copyNode<AssignStmtNode>(n); break;
+        case NodeKind::ExprStmt: c = copyNode<ExprStmtNode>(n); break;
+        case NodeKind::If: c = copyNode<IfStmtNode>(n); break;
+        case NodeKind::While: c = copyNode<WhileStmtNode>(n); break;
+        case NodeKind::Return: c = copyNode<ReturnStmtNode>(n); break;
+        case NodeKind::Break: c = copyNode<BreakStmtNode>(n); break;
+        case NodeKind::Continue: c = copyNode<ContinueStmtNode>(n); break;
+        case NodeKind::Inj: c = copyNode<InjStmtNode>(n); break;
+        case NodeKind::Literal: c = copyNode<LiteralNode>(n); break;
+        case NodeKind::BinaryOp: c = copyNode<BinaryOpNode>(n); break;
+        case NodeKind::UnaryOp: c = copyNode<UnaryOpNode>(n); break;
+        case NodeKind::VarRef: c = copyNode<VarRefNode>(n); break;
+        case NodeKind::Call: c = copyNode<CallNode>(n); break;
+        case NodeKind::StructInit: c = copyNode<StructInitNode>(n); break;
+        case NodeKind::PointerAssign: c = copyNode<PointerAssignNode>(n); break;
+        case NodeKind::MemberAccess: c = copyNode<MemberAccessNode>(n); break;
+        case NodeKind::ArrayLiteral: c = copyNode<ArrayLiteralNode>(n); break;
+        case NodeKind::ArrayIndex: c = copyNode<ArrayIndexNode>(n); break;
+        default: throw std::runtime_error("Cannot copy AST node");
+    }
+    c->line = line(c->line);
+    c->resolvedType = type(c->resolvedType);
+    visitChildren(c, [&](NodePtr& child) { child = copyTree(child, type, line); });
+    return c;
+}
+
+// Front end per modul: tiap modul @load di-parse sendiri lalu def-nya disalin
+// ke program (tipe dipetakan ke tabel program, baris digeser ke baris link).
+// Hasil parse disimpan di Module, jadi modul yang isinya tidak berubah tidak
+// di-parse ulang. Hasil checker disimpan per modul dengan kunci hash
+// antarmuka program (signature fungsi, struct, alias tipe): selama antarmuka
+// sama, modul yang tidak berubah tidak dicek ulang. Antarmuka yang berubah
+// membuat semua modul dicek ulang.
+class ModuleFrontend {
+    static constexpr size_t MaxChecked = 4; // antarmuka yang diingat per modul
+
+    const std::vector<LinkedModule>& modules;
+    std::shared_ptr<TypeTable> types;
+    bool debug;
+    uint64_t interface = 0;
+    std::vector<std::shared_ptr<ParsedModule>> parsed;          // per modul link
+    std::vector<std::shared_ptr<const CheckedModule>> reusable; // per modul; null: dicek ulang
+    std::vector<std::vector<NodePtr>> imported;                 // per modul, sejajar dengan defs
+
+public:
+    int parseReused = 0;
+    int parsedNow = 0;
+    int checkReused = 0;
+    int checkedNow = 0;
+
+    // debug: --debug mencetak token, jadi semua modul di-parse ulang tanpa cache.
+    ModuleFrontend(const std::vector<LinkedModule>& m, std::shared_ptr<TypeTable> t, bool dbg)
+        : modules(m), types(std::move(t)), debug(dbg) {}
+
+    // Program gabungan. Error parse dan definisi tipe ganda dilaporkan ke diags
+    // menurut urutan baris.
+    std::shared_ptr<ProgramNode> build(Diagnostics& diags) {
+        struct Def {
+            int line;
+            size_t module;
+            size_t index;
+        };
+        std::vector<Def> order;
+        std::vector<Diagnostic> errors;
+        for (size_t i = 0; i < modules.size(); ++i) {
+            parsed.push_back(parse(*modules[i].module));
+            auto& pm = *parsed.back();
+            for (size_t d = 0; d < pm.defs.size(); ++d) order.push_back({globalLine(i, pm.defs[d]->line), i, d});
+            for (auto& e : pm.errors) errors.push_back({globalLine(i, e.line), e.column, e.message});
+        }
+        std::stable_sort(order.begin(), order.end(), [](const Def& a, const Def& b) { return a.line < b.line; });
+
+        interface = 1469598103934665603ULL;
+        for (auto& d : order) {
+            uint64_t h = parsed[d.module]->interfaces[d.index];
+            for (int b = 0; b < 64; b += 8) {
+                interface ^= (h >> b) & 0xff;
+                interface *= 1099511628211ULL;
+            }
+        }
+
+        reusable.assign(modules.size(), nullptr);
+        imported.assign(modules.size(), {});
+        std::vector<std::unique_ptr<TypeImporter>> importers(modules.size());
+        for (size_t i = 0; i < modules.size(); ++i) {
+            imported[i].resize(parsed[i]->defs.size());
+            if (!debug && parsed[i]->errors.empty()) {
+                std::lock_guard<std::mutex> lock(parsed[i]->mutex);
+                for (auto& c : parsed[i]->checked) {
+                    if (c->interface == interface) reusable[i] = c;
+                }
+            }
+            ++(reusable[i] ? checkReused : checkedNow);
+            importers[i].reset(new TypeImporter(reusable[i] ? *reusable[i]->types : *parsed[i]->types, *types));
+        }
+
+        auto program = std::make_shared<ProgramNode>();
+        for (auto& d : order) {
+            const NodePtr& def = reusable[d.module] ? reusable[d.module]->defs[d.index] : parsed[d.module]->defs[d.index];
+            TypeImporter& type = *importers[d.module];
+            auto line = [&](int l) { return globalLine(d.module, l); };
+            // Nama tipe ganda antar modul dilaporkan di definisinya, lalu def dibuang.
+            try {
+                if (def->kind == NodeKind::StructDef) {
+                    types->defineStruct(std::static_pointer_cast<StructDefNode>(def)->name);
+                } else if (def->kind == NodeKind::TypeInit) {
+                    auto alias = std::static_pointer_cast<TypeInitNode>(def);
+                    types->defineAlias(alias->name, type(alias->type));
+                }
+            } catch (const std::runtime_error& e) {
+                errors.push_back({line(def->line), def->column, e.what()});
+                continue;
+            }
+            NodePtr copy = copyTree(def, type, line);
+            if (reusable[d.module] && copy->kind == NodeKind::FunctionDef) {
+                std::static_pointer_cast<FunctionDefNode>(copy)->checked = true;
+            }
+            imported[d.module][d.index] = copy;
+            program->topDefs.push_back(copy);
+        }
+        types->resolveAliases();
+
+        std::stable_sort(errors.begin(), errors.end(), [](const Diagnostic& a, const Diagnostic& b) { return a.line < b.line; });
+        for (auto& e : errors) diags.report(e);
+        return program;
+    }
+
+    // Setelah checker tanpa error (sebelum codegen mengubah AST): simpan hasil
+    // cek modul yang baru dicek untuk kompilasi berikutnya.
+    void remember() {
+        if (debug) return;
+        for (size_t i = 0; i < modules.size(); ++i) {
+            if (reusable[i]) continue;
+            std::unordered_map<int, int> local;
+            const std::vector<int>& lines = modules[i].lines;
+            for (size_t k = 1; k < lines.size(); ++k) local[lines[k]] = (int)k;
+            auto line = [&](int l) {
+                auto it = local.find(l);
+                return it == local.end() ? 0 : it->second;
+            };
+            auto same = [](TypeId t) { return t; };
+            auto entry = std::make_shared<CheckedModule>();
+            entry->interface = interface;
+            entry->types = types;
+            for (auto& def : imported[i]) entry->defs.push_back(def ? copyTree(def, same, line) : nullptr);
+
+            ParsedModule& pm = *parsed[i];
+            std::lock_guard<std::mutex> lock(pm.mutex);
+            pm.checked.push_back(entry);
+            if (pm.checked.size() > MaxChecked) pm.checked.erase(pm.checked.begin());
+        }
+    }
+
+private:
+    int globalLine(size_t module, int line) const {
+        const std::vector<int>& lines = modules[module].lines;
+        return line > 0 && line < (int)lines.size() ? lines[line] : 0;
+    }
+
+    std::shared_ptr<ParsedModule> parse(const Module& m) {
+        if (debug) {
+            ++parsedNow;
+            return parseModule(m);
+        }
+        std::lock_guard<std::mutex> lock(m.mutex);
+        if (m.parsed) {
+            ++parseReused;
+            return m.parsed;
+        }
+        ++parsedNow;
+        return m.parsed = parseModule(m);
+    }
+
+    // Baris @load menjadi baris kosong, jadi baris token = indeks baris modul.
+    std::shared_ptr<ParsedModule> parseModule(const Module& m) const {
+        auto pm = std::make_shared<ParsedModule>();
+        pm->types = std::make_shared<TypeTable>();
+        std::string text;
+        for (auto& l : m.lines) {
+            text += l.text;
+            text += '\n';
+        }
+        Tokenizer tokenizer(std::move(text), debug);
+        Diagnostics diags(0);
+        Parser parser(tokenizer, *pm->types, &diags);
+        pm->defs = std::move(parser.parseProgram()->topDefs);
+        pm->errors = diags.list();
+        for (auto& def : pm->defs) pm->interfaces.push_back(interfaceOf(def, *pm->types));
+        return pm;
+    }
+
+    // Bagian def yang dipakai checker saat mengecek modul lain.
+    static uint64_t interfaceOf(const NodePtr& def, const TypeTable& t) {
+        std::string s;
+        if (def->kind == NodeKind::FunctionDef) {
+            auto fn = std::static_pointer_cast<FunctionDefNode>(def);
+            s = "fn " + fn->name + " " + t.name(fn->returnType);
+        } else if (def->kind == NodeKind::StructDef) {
+            auto st = std::static_pointer_cast<StructDefNode>(def);
+            s = "struct " + st->name + (st->baseAddress ? " at" : "");
+            for (auto& [name, type] : st->fields) s += " " + name + ":" + t.name(type);
+        } else if (def->kind == NodeKind::TypeInit) {
+            auto alias = std::static_pointer_cast<TypeInitNode>(def);
+            s = "type " + alias->name + "=" + t.name(alias->type);
+        } else {
+            return 0;
+        }
+        return ModuleCache::fnv1a(s);
+    }
+};
+
+#endif
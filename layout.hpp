@@ -0,0 +1,230 @@
+#ifndef LAYOUT_HPP
+#define LAYOUT_HPP
+
+#include "ast.hpp"
+#include "diagnostics.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+struct FieldLayout {
+    std::string name;
+    TypeId type = NoType;
+    int offset = 0;
+    int size = 0;
+    int align = 1;
+};
+
+struct StructLayout {
+    std::string name;
+    std::vector<FieldLayout> fields;
+    std::unordered_map<std::string, int> fieldIndex;
+    int size = 0;
+    int align = 1;
+    bool packed = false;
+    uint64_t baseAddress = 0;
+
+    const FieldLayout* field(const std::string& fieldName) const {
+        auto it = fieldIndex.find(fieldName);
+        return it == fieldIndex.end() ? nullptr : &fields[it->second];
+    }
+};
+
+// Menghitung ukuran, alignment dan offset field struct sesuai tipe aslinya.
+// Ukuran setiap tipe di-cache di TypeTable.
+class LayoutEngine {
+    TypeTable& types;
+    std::unordered_map<TypeId, std::shared_ptr<StructDefNode>> defs;
+    std::unordered_map<TypeId, StructLayout> layouts;
+    std::unordered_set<TypeId> inProgress;
+    std::vector<TypeId> order;
+
+public:
+    explicit LayoutEngine(TypeTable& t) : types(t) {}
+
+    TypeTable& typeTable() { return types; }
+
+    // Dengan diags, align yang salah dan struct yang memuat dirinya sendiri
+    // dilaporkan di lokasi definisinya; layout hanya dihitung bila belum ada error.
+    void collect(const std::shared_ptr<ProgramNode>& program, Diagnostics* diags = nullptr) {
+        for (auto& def : program->topDefs) {
+            if (def->kind == NodeKind::StructDef) {
+                auto s = std::dynamic_pointer_cast<StructDefNode>(def);
+                defs[s->id] = s;
+                order.push_back(s->id);
+            }
+        }
+        if (diags) {
+            validate(*diags);
+            if (diags->hasErrors()) return;
+        }
+        for (TypeId id : order) layoutOf(id);
+        // Isi cache array sekarang supaya pembacaan berikutnya tidak menulis apa pun.
+        for (TypeId id = 0; id < types.size(); ++id) {
+            if (types.isArray(id)) sizeOf(id);
+        }
+    }
+
+    bool isStruct(TypeId type) const {
+        return types.isStruct(type);
+    }
+
+    const StructLayout& layoutOf(TypeId structType) {
+        TypeId id = types.canonical(structType);
+        auto done = layouts.find(id);
+        if (done != layouts.end()) return done->second;
+
+        auto it = defs.find(id);
+        if (it == defs.end()) throw std::runtime_error("Undefined struct: " + types.name(structType));
+        const std::string& name = types.name(id);
+        if (inProgress.count(id)) {
+            throw std::runtime_error("Struct '" + name + "' contains itself at line " + std::to_string(it->second->line));
+        }
+        inProgress.insert(id);
+
+        auto& def = it->second;
+        StructLayout layout;
+        layout.name = name;
+        layout.packed = def->packed;
+        layout.baseAddress = def->baseAddress;
+
+        int offset = 0;
+        int maxAlign = 1;
+        for (auto& [fieldName, fieldType] : def->fields) {
+            FieldLayout f;
+            f.name = fieldName;
+            f.type = fieldType;
+            f.size = sizeOf(fieldType);
+            f.align = def->packed ? 1 : alignOf(fieldType);
+            offset = alignUp(offset, f.align);
+            f.offset = offset;
+            offset += f.size;
+            if (f.align > maxAlign) maxAlign = f.align;
+            layout.fieldIndex[fieldName] = (int)layout.fields.size();
+            layout.fields.push_back(f);
+        }
+
+        if (def->align) {
+            if (def->align < 0 || (def->align & (def->align - 1)) != 0) {
+                throw std::runtime_error("align(" + std::to_string(def->align) + ") of struct '" + name + "' is not a power of two");
+            }
+            if (def->align > maxAlign) maxAlign = def->align;
+        }
+        layout.align = maxAlign;
+        layout.size = alignUp(offset, maxAlign);
+        types.setLayout(id, layout.size, layout.align);
+
+        inProgress.erase(id);
+        return layouts[id] = layout;
+    }
+
+    int sizeOf(TypeId type) {
+        return computeLayout(type).size;
+    }
+
+    int alignOf(TypeId type) {
+        return computeLayout(type).align;
+    }
+
+    bool isSigned(TypeId type) const {
+        return types.isSigned(type);
+    }
+
+    // Load/store sesuai lebar field: ldrb/ldrh/ldr w/ldr x.
+    std::string loadInstr(TypeId type, int reg, const std::string& addr) {
+        std::string r = std::to_string(reg);
+        bool sgn = isSigned(type);
+        switch (sizeOf(type)) {
+            case 1: return sgn ? "  ldrsb x" + r + ", " + addr : "  ldrb w" + r + ", " + addr;
+            case 2: return sgn ? "  ldrsh x" + r + ", " + addr : "  ldrh w" + r + ", " + addr;
+            case 4: return sgn ? "  ldrsw x" + r + ", " + addr : "  ldr w" + r + ", " + addr;
+            default: return "  ldr x" + r + ", " + addr;
+        }
+    }
+
+    // reg < 0 menyimpan nol (wzr/xzr).
+    std::string storeInstr(TypeId type, int reg, const std::string& addr) {
+        std::string w = reg < 0 ? "wzr" : "w" + std::to_string(reg);
+        std::string x = reg < 0 ? "xzr" : "x" + std::to_string(reg);
+        switch (sizeOf(type)) {
+            case 1: return "  strb " + w + ", " + addr;
+            case 2: return "  strh " + w + ", " + addr;
+            case 4: return "  str " + w + ", " + addr;
+            default: return "  str " + x + ", " + addr;
+        }
+    }
+
+    void dump(std::ostream& out) {
+        for (TypeId id : order) {
+            const StructLayout& l = layoutOf(id);
+            out << "struct " << l.name << " size=" << l.size << " align=" << l.align;
+            if (l.packed) out << " packed";
+            if (l.baseAddress) out << " at=0x" << std::hex << l.baseAddress << std::dec;
+            out << "\n";
+            for (auto& f : l.fields) {
+                out << "  +" << f.offset << "\t" << f.name << " " << types.name(f.type)
+                    << " size=" << f.size << " align=" << f.align << "\n";
+            }
+        }
+    }
+
+    static int alignUp(int value, int align) {
+        return align > 1 ? (value + align - 1) / align * align : value;
+    }
+
+private:
+    void validate(Diagnostics& diags) {
+        std::unordered_map<TypeId, int> state; // 1: sedang dikunjungi, 2: selesai
+        for (TypeId id : order) {
+            auto& def = defs[id];
+            if (def->align && (def->align < 0 || (def->align & (def->align - 1)) != 0)) {
+                diags.error(def->line, def->column, "align(" + std::to_string(def->align) + ") of struct '" + def->name + "' is not a power of two");
+            }
+            if (!state[id]) checkContainment(id, state, diags);
+        }
+    }
+
+    // DFS lewat field struct (termasuk array of struct) untuk mencari siklus.
+    void checkContainment(TypeId id, std::unordered_map<TypeId, int>& state, Diagnostics& diags) {
+        state[id] = 1;
+        for (auto& field : defs[id]->fields) {
+            TypeId t = types.canonical(field.second);
+            while (types.isArray(t)) t = types.canonical(types.element(t));
+            if (!types.isStruct(t) || !defs.count(t)) continue;
+            int s = state[t];
+            if (s == 1) {
+                auto& def = defs[t];
+                diags.error(def->line, def->column, "struct '" + def->name + "' contains itself");
+            } else if (s == 0) {
+                checkContainment(t, state, diags);
+            }
+        }
+        state[id] = 2;
+    }
+
+    const TypeInfo& computeLayout(TypeId type) {
+        if (type == NoType) throw std::runtime_error("Missing type");
+        TypeId id = types.canonical(type);
+        const TypeInfo& t = types.info(id);
+        if (t.size >= 0) return t;
+        switch (t.kind) {
+            case TypeKind::Struct:
+                layoutOf(id);
+                break;
+            case TypeKind::Array: {
+                int size = alignUp(sizeOf(t.elem), alignOf(t.elem)) * t.count;
+                types.setLayout(id, size, alignOf(t.elem));
+                break;
+            }
+            default:
+                throw std::runtime_error("Unknown type '" + types.name(type) + "'");
+        }
+        return t;
+    }
+};
+
+#endif
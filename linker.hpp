@@ -3,56 +3,195 @@
 
 #include <string>
 #include <unordered_set>
+#include <unordered_map>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
+#include <vector>
+#include <cstdint>
+#include <climits>
+#include <memory>
+#include <mutex>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <ctime>
+#include "diagnostics.hpp"
 
-class Linker {
-    std::unordered_set<std::string> loadedFiles;
+// Satu file sumber setelah komentar dan indentasi dibuang.
+struct ModuleLine {
+    std::string text;
+    int line = 0;
+    int indent = 0;
+    std::string load; // tidak kosong: baris @load "..."
+};
+
+struct ParsedModule; // frontend.hpp
+
+struct Module {
+    std::vector<ModuleLine> lines;
+    int lastLine = 0;
+    timespec mtime = {};
+    off_t size = 0;
+    uint64_t hash = 0;
+    // Hasil parse (dan cek) modul ini, diisi frontend saat pertama dipakai.
+    mutable std::mutex mutex;
+    mutable std::shared_ptr<ParsedModule> parsed;
+};
+
+// Modul yang sudah dipraproses (dan di-parse, lihat frontend.hpp), dipakai
+// ulang selama file tidak berubah (mtime+ukuran sama, atau isinya sama menurut
+// hash). Dipakai bersama oleh unit batch dan request daemon; modul yang
+// berubah diganti objek baru, jadi pemegang modul lama tidak terganggu.
+class ModuleCache {
+    std::unordered_map<std::string, std::shared_ptr<Module>> modules; // kunci: path absolut
+    std::mutex mutex;
 
 public:
-    std::string link(const std::string& path) {
-        loadedFiles.clear();
-        return processFile(path);
+    std::shared_ptr<const Module> get(const std::string& path, bool& reused) {
+        struct stat st;
+        char resolved[PATH_MAX];
+        if (::stat(path.c_str(), &st) != 0 || !::realpath(path.c_str(), resolved))
+            throw std::runtime_error("Failed to open file: " + path);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::shared_ptr<Module>& slot = modules[resolved];
+        reused = true;
+        // File yang diubah kurang dari sedetik lalu bisa diubah lagi tanpa mtime
+        // baru (resolusi timestamp filesystem), jadi isinya tetap di-hash.
+        if (slot && sameTime(slot->mtime, st.st_mtim) && slot->size == st.st_size && !recent(st.st_mtim)) return slot;
+
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) throw std::runtime_error("Failed to open file: " + path);
+        std::ostringstream buf;
+        buf << in.rdbuf();
+        std::string content = buf.str();
+        uint64_t hash = fnv1a(content);
+
+        if (!slot || slot->hash != hash) {
+            reused = false;
+            slot = std::make_shared<Module>();
+            preprocess(content, *slot);
+            slot->hash = hash;
+        }
+        slot->mtime = st.st_mtim;
+        slot->size = st.st_size;
+        return slot;
     }
 
 private:
-    std::string processFile(const std::string& filepath) {
-        if (loadedFiles.count(filepath)) return ""; 
-        loadedFiles.insert(filepath);
+    static bool sameTime(const timespec& a, const timespec& b) {
+        return a.tv_sec == b.tv_sec && a.tv_nsec == b.tv_nsec;
+    }
 
-        std::ifstream in(filepath);
-        if (!in.is_open()) throw std::runtime_error("Failed to open file: " + filepath);
+    static bool recent(const timespec& t) {
+        timespec now;
+        ::clock_gettime(CLOCK_REALTIME, &now);
+        return (now.tv_sec - t.tv_sec) * 1000000000LL + (now.tv_nsec - t.tv_nsec) < 1000000000LL;
+    }
 
-        std::ostringstream result;
+    static void preprocess(const std::string& content, Module& m) {
+        std::istringstream in(content);
         std::string line;
+        int lineNo = 0;
 
         while (std::getline(in, line)) {
+            ++lineNo;
             size_t commentPos = line.find('#');
             if (commentPos != std::string::npos) {
                 line = line.substr(0, commentPos);
             }
-            
-            line.erase(0, line.find_first_not_of(" \t"));
+
+            size_t indent = line.find_first_not_of(" \t");
+            line.erase(0, indent);
             line.erase(line.find_last_not_of(" \t") + 1);
 
             if (line.rfind("@load", 0) == 0) {
                 size_t firstQuote = line.find('"');
                 size_t lastQuote = line.rfind('"');
                 if (firstQuote != std::string::npos && lastQuote != std::string::npos && firstQuote < lastQuote) {
-                    std::string path = line.substr(firstQuote + 1, lastQuote - firstQuote - 1);
-                    result << processFile(path) << "\n";
+                    ModuleLine l;
+                    l.line = lineNo;
+                    l.load = line.substr(firstQuote + 1, lastQuote - firstQuote - 1);
+                    m.lines.push_back(l);
                 }
                 continue;
             }
 
-            if (!line.empty()) {
-                result << line << "\n";
+            if (!line.empty()) m.lines.push_back({line, lineNo, (int)indent, ""});
+        }
+        m.lastLine = lineNo;
+    }
+
+public:
+    static uint64_t fnv1a(const std::string& s) {
+        uint64_t h = 1469598103934665603ULL;
+        for (unsigned char c : s) {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+};
+
+// Modul dalam urutan link. lines[k] = baris hasil link untuk baris praproses
+// ke-k modul itu (1..n; n + 1 = akhir file), dipakai menggeser baris AST
+// yang di-parse per modul.
+struct LinkedModule {
+    std::string path;
+    std::shared_ptr<const Module> module;
+    std::vector<int> lines;
+};
+
+class Linker {
+    std::unordered_set<std::string> loadedFiles;
+    std::vector<SourceLoc> lines; // satu entri per baris hasil link
+    std::vector<LinkedModule> linked;
+    ModuleCache own;
+    ModuleCache* modules;
+
+public:
+    int reused = 0;   // modul yang diambil dari cache
+    int reloaded = 0; // modul yang dibaca dan diproses ulang
+
+    // shared: cache modul yang hidup lebih lama dari satu kompilasi (daemon).
+    explicit Linker(ModuleCache* shared = nullptr) : modules(shared ? shared : &own) {}
+
+    // Modul @load disisipkan di tempat barisnya; tiap file hanya sekali.
+    const std::vector<LinkedModule>& link(const std::string& path) {
+        loadedFiles.clear();
+        lines.clear();
+        linked.clear();
+        reused = reloaded = 0;
+        processFile(path);
+        return linked;
+    }
+
+    const std::vector<SourceLoc>& sourceMap() const { return lines; }
+
+private:
+    void processFile(const std::string& filepath) {
+        if (loadedFiles.count(filepath)) return;
+        loadedFiles.insert(filepath);
+
+        bool cached = false;
+        std::shared_ptr<const Module> module = modules->get(filepath, cached);
+        ++(cached ? reused : reloaded);
+        size_t self = linked.size();
+        linked.push_back({filepath, module, std::vector<int>(module->lines.size() + 2, 0)});
+
+        for (size_t k = 0; k < module->lines.size(); ++k) {
+            const ModuleLine& line = module->lines[k];
+            if (!line.load.empty()) {
+                processFile(line.load);
+                lines.push_back({filepath, line.line, 0});
+            } else {
+                lines.push_back({filepath, line.line, line.indent});
             }
+            linked[self].lines[k + 1] = (int)lines.size();
         }
 
-        result << "\n";
-        return result.str();
+        lines.push_back({filepath, module->lastLine, 0});
+        linked[self].lines[module->lines.size() + 1] = (int)lines.size();
     }
 };
 
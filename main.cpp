@@ -2,54 +2,307 @@
 #include "codegen.cpp"
 #include "linker.hpp"
 #include "checker.cpp"
+#include "frontend.hpp"
+#include "layout.hpp"
+#include "daemon.hpp"
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstdio>
+#include <map>
+#include <set>
 
-int main(int argc, char* argv[]) {
+struct CompileOptions {
     bool debug = false;
-    std::string inputPath, outputPath;
-
-    if (argc == 4 && std::string(argv[1]) == "--debug") {
-        debug = true;
-        inputPath = argv[2];
-        outputPath = argv[3];
-    } else if (argc == 3) {
-        inputPath = argv[1];
-        outputPath = argv[2];
-    } else {
-        std::cerr << "Usage: " << argv[0] << " [--debug] input.q output.s\n";
-        return 1;
-    }
+    bool dumpLayouts = false;
+    bool optReport = false;
+    bool lse = false; // --target-features lse: atomik ARMv8.1
+    int jobs = 1;
+    int maxErrors = 20;
+    std::string cachePath;
+};
+
+// State yang dipakai bersama antar unit batch dan antar request daemon.
+struct WarmState {
+    ModuleCache modules;
+    std::mutex mutex; // menjaga functions
+    std::map<std::string, std::unique_ptr<FunctionCache>> functions; // per path output/cache absolut
+    bool keepFunctions = false; // daemon: cache fungsi tetap di memori tanpa --cache
+    std::atomic<int> parseReused{0}, parsed{0}; // modul, dijumlah dari semua unit
+    std::atomic<int> checkReused{0}, checked{0};
+};
 
+static std::string absolutePath(const std::string& path) {
+    if (!path.empty() && path[0] == '/') return path;
+    char cwd[PATH_MAX];
+    return ::getcwd(cwd, sizeof cwd) ? std::string(cwd) + "/" + path : path;
+}
+
+// Satu unit: input.q -> output.s. Pesan ditulis ke out/err supaya unit batch
+// yang berjalan bersamaan tidak saling menyela.
+static int compileUnit(const CompileOptions& opt, const std::string& inputPath, const std::string& outputPath,
+                       const std::string& cachePath, WarmState* warm, std::ostream& out, std::ostream& err) {
     try {
-        Linker linker;
-        std::string source = linker.link(inputPath);
+        Linker linker(warm ? &warm->modules : nullptr);
+        const std::vector<LinkedModule>& modules = linker.link(inputPath);
 
-        Tokenizer tokenizer(source, debug);
-        std::vector<Token> tokens = tokenizer.tokenize();
+        // Parser, checker dan validasi layout mengumpulkan semua error sebelum berhenti.
+        Diagnostics diags(opt.maxErrors, &linker.sourceMap());
+        auto types = std::make_shared<TypeTable>();
+        LayoutEngine layouts(*types);
+        ModuleFrontend frontend(modules, types, opt.debug);
+        std::shared_ptr<ProgramNode> program;
+        try {
+            program = frontend.build(diags);
+            if (warm) {
+                warm->parseReused += frontend.parseReused;
+                warm->parsed += frontend.parsedNow;
+                warm->checkReused += frontend.checkReused;
+                warm->checked += frontend.checkedNow;
+            }
 
-        Parser parser(tokens);
-        auto program = parser.parseProgram();
+            SemanticChecker checker(*types, opt.jobs, &diags);
+            checker.check(program);
+            layouts.collect(program, &diags);
+        } catch (const TooManyErrors&) {
+            diags.print(err);
+            err << "Stopped after " << diags.count() << " errors (--max-errors " << opt.maxErrors << ")\n";
+            return 1;
+        }
+        if (diags.hasErrors()) {
+            diags.print(err);
+            err << diags.count() << " error(s), no output written\n";
+            return 1;
+        }
 
-        SemanticChecker checker;
-        checker.check(program);
+        // Sebelum codegen: SRA dan CSE mengubah AST.
+        frontend.remember();
 
-        CodegenASM codegen;
-        std::string asmCode = codegen.generate(program);
+        if (opt.dumpLayouts) layouts.dump(out);
 
-        std::ofstream outFile(outputPath);
-        if (!outFile.is_open()) {
-            std::cerr << "Error: Cannot write to output file: " << outputPath << "\n";
-            return 1;
+        CodegenASM codegen(layouts, opt.jobs);
+        codegen.setLse(opt.lse);
+        // Daemon selalu menyimpan cache fungsi di memori; --cache menambah file.
+        std::unique_ptr<FunctionCache> ownCache;
+        FunctionCache* cache = nullptr;
+        if (warm && (warm->keepFunctions || !cachePath.empty())) {
+            std::string key = absolutePath(cachePath.empty() ? outputPath : cachePath);
+            std::lock_guard<std::mutex> lock(warm->mutex);
+            auto& slot = warm->functions[key];
+            if (!slot) slot.reset(cachePath.empty() ? new FunctionCache() : new FunctionCache(cachePath));
+            cache = slot.get();
+        } else if (!cachePath.empty()) {
+            ownCache.reset(new FunctionCache(cachePath));
+            cache = ownCache.get();
+        }
+        if (cache) codegen.setCache(cache);
+        FileSink outFile(outputPath);
+        try {
+            codegen.generate(program, outFile);
+        } catch (...) {
+            outFile.discard();
+            throw;
         }
-        outFile << asmCode;
         outFile.close();
+        if (opt.optReport) {
+            for (auto& r : codegen.stats.remarks) diags.print(out, r, "remark");
+            out << "CSE: " << codegen.stats.cseEliminated << " redundant expression(s) eliminated in "
+                << codegen.stats.cseFunctions << " function(s)\n";
+            out << "SRA: " << codegen.stats.sraStructs << " struct local(s) split into scalars\n";
+        }
+        if (cache) {
+            cache->save();
+            out << "Incremental: " << cache->reused << " function(s) reused, "
+                << cache->compiled << " recompiled\n";
+        }
+        if (warm && warm->keepFunctions) {
+            out << "Modules: " << linker.reused << " reused, " << linker.reloaded << " reloaded; parse "
+                << frontend.parseReused << " reused, " << frontend.parsedNow << " parsed; check "
+                << frontend.checkReused << " reused, " << frontend.checkedNow << " checked\n";
+        }
 
-        std::cout << "Compilation successful. Output written to " << outputPath << "\n";
+        out << "Compilation successful. Output written to " << outputPath << "\n";
         return 0;
 
+    } catch (const std::exception& e) {
+        err << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+// Manifest batch: satu pasangan "input.q output.s" per baris; '#' komentar.
+static std::vector<std::pair<std::string, std::string>> readManifest(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) throw std::runtime_error("Failed to open manifest: " + path);
+    std::vector<std::pair<std::string, std::string>> units;
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        size_t commentPos = line.find('#');
+        if (commentPos != std::string::npos) line = line.substr(0, commentPos);
+        std::istringstream fields(line);
+        std::string input, output, extra;
+        if (!(fields >> input)) continue;
+        if (!(fields >> output) || (fields >> extra))
+            throw std::runtime_error(path + ":" + std::to_string(lineNo) + ": expected 'input.q output.s'");
+        units.emplace_back(input, output);
+    }
+    return units;
+}
+
+// Semua unit dalam satu proses: modul @load dibaca dan diproses sekali untuk
+// semua unit, unit dikompilasi oleh -j worker (tiap unit serial di dalamnya).
+// Keluaran tiap unit dicetak utuh menurut urutan manifest.
+static int compileBatch(const CompileOptions& opt, const std::vector<std::pair<std::string, std::string>>& units,
+                        WarmState* warm) {
+    std::set<std::string> outputs;
+    for (auto& unit : units) {
+        if (!outputs.insert(absolutePath(unit.second)).second)
+            throw std::runtime_error("Output " + unit.second + " appears more than once in batch");
+    }
+
+    WarmState local;
+    if (!warm) warm = &local;
+    int parseReused = warm->parseReused, parsed = warm->parsed;
+    int checkReused = warm->checkReused, checked = warm->checked;
+    CompileOptions unitOpt = opt;
+    unitOpt.jobs = 1;
+
+    struct UnitResult {
+        std::ostringstream out, err;
+        int code = 0;
+        bool done = false;
+    };
+    std::vector<UnitResult> results(units.size());
+    std::atomic<size_t> next{0};
+    std::mutex doneMutex;
+    std::condition_variable doneCv;
+    auto worker = [&]() {
+        for (size_t i; (i = next.fetch_add(1)) < units.size();) {
+            // --cache di mode batch menunjuk direktori: satu file cache per output,
+            // dinamai dari nama file plus hash path absolutnya.
+            std::string cachePath;
+            if (!opt.cachePath.empty()) {
+                std::string output = absolutePath(units[i].second);
+                char hash[17];
+                std::snprintf(hash, sizeof hash, "%016llx", (unsigned long long)ModuleCache::fnv1a(output));
+                cachePath = opt.cachePath + "/" + output.substr(output.rfind('/') + 1) + "." + hash + ".qcache";
+            }
+            UnitResult& r = results[i];
+            r.code = compileUnit(unitOpt, units[i].first, units[i].second, cachePath, warm, r.out, r.err);
+            std::lock_guard<std::mutex> lock(doneMutex);
+            r.done = true;
+            doneCv.notify_one();
+        }
+    };
+
+    int workers = opt.jobs > 0 ? opt.jobs : (int)std::thread::hardware_concurrency();
+    if (workers > (int)units.size()) workers = (int)units.size();
+    if (workers < 1) workers = 1;
+    std::vector<std::thread> pool;
+    for (int t = 0; t < workers; ++t) pool.emplace_back(worker);
+
+    int failed = 0;
+    for (auto& r : results) {
+        {
+            std::unique_lock<std::mutex> lock(doneMutex);
+            doneCv.wait(lock, [&] { return r.done; });
+        }
+        std::cout << r.out.str();
+        std::cerr << r.err.str();
+        if (r.code != 0) ++failed;
+    }
+    for (auto& th : pool) th.join();
+
+    std::cout << "Batch: " << units.size() - failed << " of " << units.size() << " unit(s) compiled";
+    if (failed) std::cout << ", " << failed << " failed";
+    std::cout << "\n";
+    // Modul @load bersama di-parse sekali; hasil cek hanya dipakai unit lain
+    // bila antarmuka programnya sama (lihat frontend.hpp).
+    std::cout << "Modules: parse " << warm->parseReused - parseReused << " reused, " << warm->parsed - parsed
+              << " parsed; check " << warm->checkReused - checkReused << " reused, " << warm->checked - checked
+              << " checked\n";
+    return failed ? 1 : 0;
+}
+
+static int compile(const std::string& prog, const std::vector<std::string>& args, WarmState* warm) {
+    CompileOptions opt;
+    bool badArgs = false;
+    bool batch = false;
+    std::string manifestPath;
+    std::vector<std::string> positional;
+
+    int argc = (int)args.size();
+    for (int i = 0; i < argc; ++i) {
+        const std::string& arg = args[i];
+        if (arg == "--debug") opt.debug = true;
+        else if (arg == "--dump-layouts") opt.dumpLayouts = true;
+        else if (arg == "--opt-report") opt.optReport = true;
+        else if ((arg == "-j" || arg == "--jobs") && i + 1 < argc) opt.jobs = std::atoi(args[++i].c_str());
+        else if (arg.rfind("-j", 0) == 0 && arg.size() > 2) opt.jobs = std::atoi(arg.c_str() + 2);
+        else if (arg == "--max-errors" && i + 1 < argc) opt.maxErrors = std::atoi(args[++i].c_str());
+        else if (arg == "--cache" && i + 1 < argc) opt.cachePath = args[++i];
+        else if (arg == "--target-features" && i + 1 < argc) {
+            std::istringstream list(args[++i]);
+            std::string feature;
+            while (std::getline(list, feature, ',')) {
+                if (feature == "lse" || feature == "+lse") opt.lse = true;
+                else if (feature == "-lse") opt.lse = false;
+                else {
+                    std::cerr << "Unknown target feature: " << feature << "\n";
+                    return 1;
+                }
+            }
+        }
+        else if (arg == "--batch") batch = true;
+        else if (arg == "--manifest" && i + 1 < argc) manifestPath = args[++i];
+        else positional.push_back(arg);
+    }
+
+    bool batchMode = batch || !manifestPath.empty();
+    if (batchMode) badArgs = positional.size() % 2 != 0 || (positional.empty() && manifestPath.empty());
+    else badArgs = positional.size() != 2;
+    if (badArgs) {
+        std::cerr << "Usage: " << prog << " [--debug] [--dump-layouts] [--opt-report] [-j N] [--max-errors N] [--cache FILE]\n"
+                  << "       " << prog << " [--target-features lse] input.q output.s\n"
+                  << "       " << prog << " [options] --batch in1.q out1.s [in2.q out2.s ...]\n"
+                  << "       " << prog << " [options] --manifest FILE\n"
+                  << "       " << prog << " --daemon SOCKET\n"
+                  << "       " << prog << " --connect SOCKET [options] input.q output.s | --shutdown\n";
+        return 1;
+    }
+
+    if (!batchMode) return compileUnit(opt, positional[0], positional[1], opt.cachePath, warm, std::cout, std::cerr);
+
+    try {
+        std::vector<std::pair<std::string, std::string>> units;
+        if (!manifestPath.empty()) units = readManifest(manifestPath);
+        for (size_t i = 0; i + 1 < positional.size(); i += 2) units.emplace_back(positional[i], positional[i + 1]);
+        return compileBatch(opt, units, warm);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    try {
+        if (args.size() == 2 && args[0] == "--daemon") {
+            WarmState warm;
+            warm.keepFunctions = true;
+            return serveDaemon(args[1], [&](const std::vector<std::string>& request) {
+                return compile("quelang", request, &warm);
+            });
+        }
+        if (args.size() >= 2 && args[0] == "--connect") {
+            return runClient(args[1], std::vector<std::string>(args.begin() + 2, args.end()));
+        }
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << "\n";
         return 1;
     }
+    return compile(argv[0], args, nullptr);
 }
@@ -1,35 +1,93 @@
 #include "ast.hpp"
 #include "token.cpp"
+#include "diagnostics.hpp"
 #include <stdexcept>
 #include <memory>
+#include <climits>
 
 class Parser {
-    std::vector<Token> tokens;
-    size_t index = 0;
+    TokenStream tokens;
+    TypeTable& types;
+    Diagnostics* diags;
+    bool inCondition = false; // `if x {`: '{' membuka blok, bukan StructInit
 public:
-    Parser(const std::vector<Token>& toks) : tokens(toks) {}
+    // Tanpa diags, error pertama langsung dilempar.
+    Parser(Tokenizer& tokenizer, TypeTable& t, Diagnostics* d = nullptr) : tokens(tokenizer), types(t), diags(d) {}
 
-    Token peek() {
-        return index < tokens.size() ? tokens[index] : Token(END, "", -1);
+    // Referensi ke ring TokenStream; salin Token bila masih dipakai setelah
+    // parser maju beberapa token.
+    const Token& peek() {
+        return tokens.peek();
     }
 
-    Token get() {
-        return index < tokens.size() ? tokens[index++] : Token(END, "", -1);
+    const Token& get() {
+        return tokens.get();
+    }
+
+    [[noreturn]] void error(const std::string& msg, const Token& t) {
+        throw CompileError(msg, t.line, t.column);
+    }
+
+    static std::string describe(const Token& t) {
+        if (t.type == END) return "end of file";
+        if (t.type == NEWLINE) return "end of line";
+        return "'" + t.value + "'";
+    }
+
+    void fail(const CompileError& e) {
+        if (!diags) throw e;
+        diags->report(e);
+    }
+
+    // Panic mode: buang token sampai akhir baris, '}' penutup, atau def berikutnya.
+    void syncStatement() {
+        int depth = 0;
+        while (peek().type != END) {
+            const Token& t = peek();
+            if (t.type == KEYWORD && t.value == "def") return;
+            if (t.type == NEWLINE && depth == 0) {
+                tokens.advance();
+                return;
+            }
+            if (t.type == SYMBOL && t.value == "{") depth++;
+            if (t.type == SYMBOL && t.value == "}") {
+                if (depth == 0) return;
+                depth--;
+            }
+            tokens.advance();
+        }
+    }
+
+    // Nama tipe ganda dilaporkan di lokasi definisinya.
+    template<typename F>
+    void defineType(const Token& at, F&& define) {
+        try {
+            define();
+        } catch (const std::runtime_error& e) {
+            error(e.what(), at);
+        }
+    }
+
+    void syncTopLevel() {
+        while (peek().type != END) {
+            if (tokens.atLineStart() && peek().type == KEYWORD && (peek().value == "def" || peek().value == "init")) return;
+            tokens.advance();
+        }
     }
 
     bool accept(TokenType type, const std::string& val = "") {
-        Token t = peek();
+        const Token& t = peek();
         if (t.type == type && (val.empty() || t.value == val)) {
-            index++;
+            tokens.advance();
             return true;
         }
         return false;
     }
 
     void expect(TokenType type, const std::string& val = "") {
-        Token t = get();
+        const Token& t = get();
         if (t.type != type || (!val.empty() && t.value != val)) {
-            throw std::runtime_error("Unexpected token at line " + std::to_string(t.line) + ": expected " + val);
+            error("expected '" + val + "', found " + describe(t), t);
         }
     }
 
@@ -38,39 +96,65 @@ public:
     }
 
     std::string expectIdent() {
-        Token t = get();
+        const Token& t = get();
         if (t.type != IDENT) {
-            throw std::runtime_error("Expected identifier at line " + std::to_string(t.line));
+            error("expected identifier, found " + describe(t), t);
         }
         return t.value;
     }
 
-    std::string expectType() {
-        std::string ptrPrefix = "";
-        while (accept(SYMBOL, "*")) {
-            ptrPrefix += "*";
+    std::string expectNumber() {
+        const Token& t = get();
+        if (t.type != NUMBER) {
+            error("expected number, found " + describe(t), t);
         }
+        return t.value;
+    }
 
-        if (accept(SYMBOL, "[")) {
-            std::string innerType = expectType();
-            expect(SYMBOL, "]");
-            return "[" + innerType + "]";
+    TypeId expectType() {
+        int pointers = 0;
+        while (accept(SYMBOL, "*")) {
+            pointers++;
         }
 
-        Token t = get();
-        if (t.type == KEYWORD || t.type == IDENT) {
-            return ptrPrefix + t.value;
+        TypeId base;
+        if (accept(SYMBOL, "[")) {
+            TypeId inner = expectType();
+            if (accept(SYMBOL, ";")) {
+                int count = (int)std::stoul(expectNumber(), nullptr, 0);
+                expect(SYMBOL, "]");
+                base = types.arrayOf(inner, count);
+            } else {
+                expect(SYMBOL, "]");
+                base = types.sliceOf(inner);
+            }
+        } else {
+            const Token& t = get();
+            if (t.type != KEYWORD && t.type != IDENT) {
+                error("expected type, found " + describe(t), t);
+            }
+            base = types.named(t.value);
         }
 
-        throw std::runtime_error("Expected type at line " + std::to_string(t.line));
+        while (pointers--) base = types.pointerTo(base);
+        return base;
     }
     std::shared_ptr<ProgramNode> parseProgram() {
         auto program = std::make_shared<ProgramNode>();
         skipNewlines();
         while (peek().type != END) {
-            program->topDefs.push_back(parseTopDef());
+            try {
+                int line = peek().line;
+                NodePtr def = parseTopDef();
+                if (def->line == 0) def->line = line; // blok init
+                program->topDefs.push_back(def);
+            } catch (const CompileError& e) {
+                fail(e);
+                syncTopLevel();
+            }
             skipNewlines();
         }
+        types.resolveAliases();
         return program;
     }
 
@@ -82,8 +166,11 @@ public:
             if (accept(KEYWORD, "type")) {
                 std::string name = expectIdent();
                 expect(SYMBOL, "=");
-                std::string typ = expectType();
-                return std::make_shared<TypeInitNode>(name, typ, t.line);
+                TypeId typ = expectType();
+                defineType(t, [&] { types.defineAlias(name, typ); });
+                auto alias = std::make_shared<TypeInitNode>(name, typ, t.line);
+                alias->column = t.column;
+                return alias;
             } else {
                 return parseBlock();
             }
@@ -93,16 +180,24 @@ public:
             if (accept(KEYWORD, "struct")) {
                 std::string name = expectIdent();
                 auto def = std::make_shared<StructDefNode>(name, t.line);
+                def->column = t.column;
+                defineType(t, [&] { def->id = types.defineStruct(name); });
                 while (true) {
                     if (accept(IDENT, "align")) {
                         expect(SYMBOL, "(");
-                        def->align = std::stoi(expectIdent()); // angka align
+                        Token numTok = peek();
+                        unsigned long long value = ULLONG_MAX;
+                        try {
+                            value = std::stoull(expectNumber(), nullptr, 0); // dukung hex
+                        } catch (const std::out_of_range&) {}
+                        if (value > INT_MAX) error("align(" + numTok.value + ") does not fit in an int", numTok);
+                        def->align = (int)value;
                         expect(SYMBOL, ")");
                     } else if (accept(IDENT, "packed")) {
                         def->packed = true;
                     } else if (accept(IDENT, "at")) {
                         expect(SYMBOL, "(");
-                        std::string addrStr = expectIdent();
+                        std::string addrStr = expectNumber();
                         def->baseAddress = std::stoull(addrStr, nullptr, 0); // dukung hex
                         expect(SYMBOL, ")");
                     } else break;
@@ -111,9 +206,11 @@ public:
                 while (true) {
                     skipNewlines();
                     if (accept(SYMBOL, "}")) break;
+                    Token fieldTok = peek();
                     std::string field = expectIdent();
-                    std::string type = expectType();
+                    TypeId type = expectType();
                     def->fields.emplace_back(field, type);
+                    def->fieldPos.emplace_back(fieldTok.line, fieldTok.column);
                     skipNewlines();
                 }
                 return def;
@@ -123,23 +220,27 @@ public:
                 std::vector<ParamNode> params;
                 if (!accept(SYMBOL, ")")) {
                     do {
+                        Token nameTok = peek();
                         std::string pname = expectIdent();
-                        std::string ptype = expectType();
-                        params.emplace_back(pname, ptype, t.line);
+                        TypeId ptype = expectType();
+                        params.emplace_back(pname, ptype, nameTok.line);
+                        params.back().column = nameTok.column;
                     } while (accept(SYMBOL, ","));
                     expect(SYMBOL, ")");
                 }
-                std::string typ = expectType();
+                TypeId typ = expectType();
                 auto fn = std::make_shared<FunctionDefNode>();
                 fn->name = name;
                 fn->params = params;
                 fn->returnType = typ;
+                fn->line = t.line;
+                fn->column = t.column;
                 fn->body = parseBlock();
                 return fn;
             }
         }
 
-        throw std::runtime_error("Invalid top-level definition at line " + std::to_string(t.line));
+        error("expected 'def' or 'init' at top level, found " + describe(t), t);
     }
 
     std::shared_ptr<BlockNode> parseBlock() {
@@ -147,30 +248,57 @@ public:
         auto block = std::make_shared<BlockNode>();
         skipNewlines();
         while (!accept(SYMBOL, "}")) {
-            block->statements.push_back(parseStmt());
+            if (peek().type == END || (peek().type == KEYWORD && peek().value == "def")) {
+                // Blok tidak tertutup; biarkan level atas lanjut dari def berikutnya.
+                fail(CompileError("expected '}', found " + describe(peek()), peek().line, peek().column));
+                return block;
+            }
+            try {
+                block->statements.push_back(parseStmt());
+            } catch (const CompileError& e) {
+                fail(e);
+                syncStatement();
+            }
             skipNewlines();
         }
         return block;
     }
 
     NodePtr parseStmt() {
+        Token t = peek();
+        NodePtr stmt = parseStmtBody();
+        if (stmt->line == 0) stmt->line = t.line;
+        if (stmt->column == 0) stmt->column = t.column;
+        return stmt;
+    }
+
+    NodePtr parseStmtBody() {
         Token t = peek();
         if (accept(KEYWORD, "var")) {
-            int line = peek().line;
+            Token nameTok = peek();
             std::string name = expectIdent();
-            std::string typ = expectType();
+            TypeId typ = expectType();
             expect(SYMBOL, "=");
-            NodePtr expr = parseExpr();
+            NodePtr expr;
+            try {
+                expr = parseExpr();
+            } catch (const CompileError& e) {
+                // Deklarasi tetap disimpan tanpa nilai awal, agar pemakaian
+                // berikutnya tidak dilaporkan sebagai variabel tak dikenal.
+                fail(e);
+                syncStatement();
+            }
             auto decl = std::make_shared<DeclStmtNode>(DeclStmtNode{name, typ, expr});
-            decl->line = line;
+            decl->line = nameTok.line;
+            decl->column = nameTok.column;
             return decl;
         } else if (accept(KEYWORD, "if")) {
-            auto cond = parseExpr();
+            auto cond = parseCondition();
             auto block = parseBlock();
             auto node = std::make_shared<IfStmtNode>();
             node->branches.emplace_back(cond, block);
             while (accept(KEYWORD, "elseif")) {
-                auto cond2 = parseExpr();
+                auto cond2 = parseCondition();
                 auto block2 = parseBlock();
                 node->branches.emplace_back(cond2, block2);
             }
@@ -179,7 +307,7 @@ public:
             }
             return node;
         } else if (accept(KEYWORD, "while")) {
-            auto cond = parseExpr();
+            auto cond = parseCondition();
             auto block = parseBlock();
             auto node = std::make_shared<WhileStmtNode>();
             node->cond = cond;
@@ -201,7 +329,7 @@ public:
             expect(SYMBOL, "(");
             Token t = get();
             if (t.type != STRING) {
-                throw std::runtime_error("Expected string in inj() at line " + std::to_string(t.line));
+                error("expected string in inj(), found " + describe(t), t);
             }
             auto inj = std::make_shared<InjStmtNode>(t.value);
             while (accept(SYMBOL, "+")) {
@@ -232,15 +360,43 @@ public:
     }
 
     NodePtr parseExpr() {
+        return parseBinary(1);
+    }
+
+    // Precedence climbing; semua operator biner asosiatif kiri.
+    NodePtr parseBinary(int minPrec) {
         NodePtr left = parseAssignableExpr();
-        while (isOperator(peek())) {
-            std::string op = get().value;
-            NodePtr right = parseAssignableExpr();
-            left = std::make_shared<BinaryOpNode>(op, left, right);
+        while (isOperator(peek()) && precedence(peek().value) >= minPrec) {
+            Token opTok = get();
+            NodePtr right = parseBinary(precedence(opTok.value) + 1);
+            left = std::make_shared<BinaryOpNode>(opTok.value, left, right);
+            left->line = opTok.line;
+            left->column = opTok.column;
         }
         return left;
     }
 
+    static int precedence(const std::string& op) {
+        if (op == "or") return 1;
+        if (op == "and") return 2;
+        if (op == "==" || op == "!=" || op == "<" || op == ">" || op == "<=" || op == ">=") return 3;
+        if (op == "+" || op == "-") return 4;
+        return 5; // * / %
+    }
+
+    NodePtr parseCondition() {
+        inCondition = true;
+        NodePtr cond;
+        try {
+            cond = parseExpr();
+        } catch (...) {
+            inCondition = false;
+            throw;
+        }
+        inCondition = false;
+        return cond;
+    }
+
     NodePtr parseAssignableExpr() {
         return parsePostfixExpr(parseSimpleExpr());
     }
@@ -248,8 +404,11 @@ public:
     NodePtr parsePostfixExpr(NodePtr base) {
         while (true) {
             if (accept(SYMBOL, ".")) {
+                Token fieldTok = peek();
                 std::string field = expectIdent();
                 base = std::make_shared<MemberAccessNode>(base, field);
+                base->line = fieldTok.line;
+                base->column = fieldTok.column;
             } else if (accept(SYMBOL, "(")) {
                 std::vector<NodePtr> args;
                 if (!accept(SYMBOL, ")")) {
@@ -274,13 +433,23 @@ public:
     }
 
     NodePtr parseSimpleExpr() {
+        Token t = peek();
+        NodePtr expr = parseSimpleExprBody();
+        expr->line = t.line;
+        expr->column = t.column;
+        return expr;
+    }
+
+    NodePtr parseSimpleExprBody() {
+        // Akhir baris tidak ditelan, supaya pemulihan berhenti di baris ini.
+        if (peek().type == NEWLINE || peek().type == END) error("expected expression, found " + describe(peek()), peek());
         Token t = get();
         if (t.type == NUMBER || t.type == STRING || t.value == "true" || t.value == "false" || t.value == "nil") {
             return std::make_shared<LiteralNode>(t.value, t.line);
         } else if (t.type == IDENT) {
-            if (accept(SYMBOL, "{")) {
+            if (!inCondition && accept(SYMBOL, "{")) {
                 std::vector<NodePtr> args;
-                if (!accept(SYMBOL, "}") {
+                if (!accept(SYMBOL, "}")) {
                     do {
                         args.push_back(parseExpr());
                     } while (accept(SYMBOL, ","));
@@ -323,10 +492,13 @@ public:
              }
              return block;
         } else if (t.value == "(") {
+            bool saved = inCondition;
+            inCondition = false;
             NodePtr expr = parseExpr();
+            inCondition = saved;
             expect(SYMBOL, ")");
             return expr;
-        } else if (t.value == "-" || t.value == "*" || t.value == "&") {
+        } else if (t.value == "-" || t.value == "*" || t.value == "&" || t.value == "!") {
             NodePtr rhs = parseSimpleExpr();
             return std::make_shared<UnaryOpNode>(t.value, rhs);
         } else if (t.value == "[") {
@@ -341,7 +513,7 @@ public:
             }
             return arr;
         }
-        throw std::runtime_error("Unexpected expression token at line " + std::to_string(t.line));
+        error("expected expression, found " + describe(t), t);
     }
 
     bool isOperator(const Token& t) {
@@ -0,0 +1,47 @@
+#include "simulator.hpp"
+#include <fstream>
+#include <iostream>
+#include <cstdlib>
+
+// quesim: jalankan output quelang (.s) di simulator AArch64 dan cetak
+// profil per fungsi ke stderr. Kode keluar = kode exit program.
+int main(int argc, char* argv[]) {
+    SimCosts costs;
+    uint64_t maxSteps = 1000000000;
+    bool report = true;
+    std::string input;
+    bool badArgs = false;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--cost" && i + 1 < argc) costs.parse(argv[++i]);
+            else if (arg == "--max-steps" && i + 1 < argc) maxSteps = std::strtoull(argv[++i], nullptr, 0);
+            else if (arg == "--no-report") report = false;
+            else if (input.empty() && arg[0] != '-') input = arg;
+            else badArgs = true;
+        }
+        if (badArgs || input.empty()) {
+            std::cerr << "Usage: " << argv[0] << " [--cost class=N,...] [--max-steps N] [--no-report] program.s\n"
+                      << "       cost classes: alu mul div load store branch taken syscall\n";
+            return 1;
+        }
+
+        std::ifstream in(input);
+        if (!in.is_open()) throw std::runtime_error("Failed to open file: " + input);
+        Simulator sim(costs);
+        sim.maxSteps = maxSteps;
+        sim.assemble(in);
+        int code = sim.run();
+        std::cout.flush();
+        if (report) {
+            std::cerr << "Exit code: " << code << "\n";
+            if (sim.hasResult) std::cerr << sim.resultFunction << " returned " << sim.result << "\n";
+            sim.report(std::cerr);
+        }
+        return code;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
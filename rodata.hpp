@@ -0,0 +1,203 @@
+#ifndef RODATA_HPP
+#define RODATA_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <cstdint>
+#include <cctype>
+#include <functional>
+#include <stdexcept>
+#include <istream>
+#include <ostream>
+
+// Kumpulan data konstan untuk .rodata; isi yang sama hanya disimpan sekali.
+// Label diturunkan dari isi, jadi kode satu fungsi tidak bergantung pada
+// urutan fungsi lain dan pool per-fungsi bisa digabung belakangan.
+class RodataPool {
+    struct Blob {
+        std::string label;
+        std::vector<uint8_t> bytes;
+        int align;
+    };
+
+    std::map<std::string, std::string> strings;
+    std::map<std::pair<int, std::vector<uint8_t>>, std::string> blobIndex;
+    std::vector<std::pair<std::string, std::string>> stringOrder;
+    std::vector<Blob> blobs;
+    std::set<std::string> labels;
+
+public:
+    void clear() {
+        strings.clear();
+        blobIndex.clear();
+        stringOrder.clear();
+        blobs.clear();
+        labels.clear();
+    }
+
+    std::string internString(const std::string& value) {
+        auto it = strings.find(value);
+        if (it != strings.end()) return it->second;
+        std::string label = claim(".Lstr_" + hashLabel(fnv1a(0, value.data(), value.size()), value.size()));
+        strings[value] = label;
+        stringOrder.emplace_back(label, value);
+        return label;
+    }
+
+    std::string internBlob(const std::vector<uint8_t>& bytes, int align) {
+        auto key = std::make_pair(align, bytes);
+        auto it = blobIndex.find(key);
+        if (it != blobIndex.end()) return it->second;
+        uint8_t a = (uint8_t)align;
+        std::string label = claim(".Ldata_" + hashLabel(fnv1a(fnv1a(0, &a, 1), bytes.data(), bytes.size()), bytes.size()));
+        blobIndex[key] = label;
+        blobs.push_back({label, bytes, align});
+        return label;
+    }
+
+    // Tambahkan isi pool lain (urutan kemunculan dipertahankan). Label yang di
+    // pool ini berbeda (karena tabrakan hash) dikembalikan sebagai peta ganti
+    // nama untuk teks yang dibuat dengan pool lain itu.
+    std::map<std::string, std::string> merge(const RodataPool& other) {
+        std::map<std::string, std::string> renames;
+        for (auto& blob : other.blobs) {
+            std::string label = internBlob(blob.bytes, blob.align);
+            if (label != blob.label) renames[blob.label] = label;
+        }
+        for (auto& [label, value] : other.stringOrder) {
+            std::string mine = internString(value);
+            if (mine != label) renames[label] = mine;
+        }
+        return renames;
+    }
+
+    // Ganti label utuh (bukan awalan label lain) di teks assembly.
+    static std::string relabel(const std::string& text, const std::map<std::string, std::string>& renames) {
+        if (renames.empty()) return text;
+        std::string out;
+        size_t i = 0;
+        while (i < text.size()) {
+            size_t start = text.find(".L", i);
+            if (start == std::string::npos) break;
+            size_t end = start + 2;
+            while (end < text.size() && (isalnum((unsigned char)text[end]) || text[end] == '_')) ++end;
+            out.append(text, i, start - i);
+            auto it = renames.find(text.substr(start, end - start));
+            out += it != renames.end() ? it->second : text.substr(start, end - start);
+            i = end;
+        }
+        out.append(text, i, std::string::npos);
+        return out;
+    }
+
+    bool empty() const { return stringOrder.empty() && blobs.empty(); }
+
+    // Format cache inkremental: isi mentah saja, label dihitung ulang saat load.
+    void save(std::ostream& out) const {
+        out << blobs.size() << " " << stringOrder.size() << "\n";
+        for (auto& blob : blobs) {
+            out << blob.align << " " << blob.bytes.size() << "\n";
+            out.write(reinterpret_cast<const char*>(blob.bytes.data()), blob.bytes.size());
+        }
+        for (auto& entry : stringOrder) {
+            out << entry.second.size() << "\n";
+            out.write(entry.second.data(), entry.second.size());
+        }
+    }
+
+    void load(std::istream& in) {
+        size_t blobCount = 0, stringCount = 0;
+        if (!(in >> blobCount >> stringCount) || in.get() != '\n') throw std::runtime_error("bad rodata record");
+        for (size_t i = 0; i < blobCount; ++i) {
+            int align = 0;
+            size_t n = 0;
+            if (!(in >> align >> n) || in.get() != '\n') throw std::runtime_error("bad rodata record");
+            std::vector<uint8_t> bytes(n);
+            if (!in.read(reinterpret_cast<char*>(bytes.data()), n)) throw std::runtime_error("bad rodata record");
+            internBlob(bytes, align);
+        }
+        for (size_t i = 0; i < stringCount; ++i) {
+            size_t n = 0;
+            if (!(in >> n) || in.get() != '\n') throw std::runtime_error("bad rodata record");
+            std::string value(n, '\0');
+            if (!in.read(&value[0], n)) throw std::runtime_error("bad rodata record");
+            internString(value);
+        }
+    }
+
+    void emit(const std::function<void(const std::string&)>& out) const {
+        if (empty()) return;
+        out(".section .rodata");
+        for (auto& blob : blobs) {
+            if (blob.align > 1) out(".balign " + std::to_string(blob.align));
+            out(blob.label + ":");
+            for (size_t i = 0; i < blob.bytes.size(); i += 16) {
+                std::string row = "  .byte ";
+                for (size_t j = i; j < blob.bytes.size() && j < i + 16; ++j) {
+                    if (j > i) row += ", ";
+                    row += std::to_string(blob.bytes[j]);
+                }
+                out(row);
+            }
+        }
+        for (auto& [label, value] : stringOrder) {
+            out(label + ":");
+            out("  .asciz \"" + escape(value) + "\"");
+        }
+    }
+
+private:
+    // Dua isi berbeda dengan hash sama tidak boleh berbagi label: yang datang
+    // belakangan mendapat akhiran _1, _2, ... menurut urutan intern.
+    std::string claim(const std::string& label) {
+        if (labels.insert(label).second) return label;
+        for (int k = 1;; ++k) {
+            std::string alt = label + "_" + std::to_string(k);
+            if (labels.insert(alt).second) return alt;
+        }
+    }
+
+    static uint64_t fnv1a(uint64_t h, const void* data, size_t n) {
+        if (!h) h = 1469598103934665603ULL;
+        auto p = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < n; ++i) {
+            h ^= p[i];
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    static std::string hashLabel(uint64_t h, size_t size) {
+        static const char* hex = "0123456789abcdef";
+        std::string s = std::to_string(size) + "_";
+        for (int i = 60; i >= 0; i -= 4) s += hex[(h >> i) & 15];
+        return s;
+    }
+
+    static std::string escape(const std::string& s) {
+        std::string out;
+        for (unsigned char c : s) {
+            switch (c) {
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                default:
+                    if (c < 32 || c >= 127) {
+                        out += '\\';
+                        out += (char)('0' + (c >> 6));
+                        out += (char)('0' + ((c >> 3) & 7));
+                        out += (char)('0' + (c & 7));
+                    } else {
+                        out += (char)c;
+                    }
+            }
+        }
+        return out;
+    }
+};
+
+#endif
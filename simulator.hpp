@@ -0,0 +1,1126 @@
+#ifndef SIMULATOR_HPP
+#define SIMULATOR_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <map>
+#include <memory>
+#include <istream>
+#include <ostream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+// Simulator AArch64 untuk subset instruksi yang dihasilkan CodegenASM (plus
+// syscall exit/write lewat svc #0), supaya kode hasil compiler bisa diukur
+// tanpa hardware target. Assembly dirakit ulang dari teks: .text dimulai di
+// TextBase (4 byte per instruksi), data (.rodata/.data) menyusul sesudahnya,
+// memori lain (stack, blok MMIO) dibuat saat pertama disentuh dan berisi nol.
+
+// Biaya siklus per kelas instruksi; perkiraan kasar in-order core, bisa
+// diubah lewat "kelas=n,kelas=n".
+struct SimCosts {
+    int alu = 1;
+    int mul = 3;
+    int div = 12;
+    int load = 4;
+    int store = 1;
+    int branch = 1;
+    int taken = 2;   // tambahan untuk branch yang diambil
+    int syscall = 50;
+
+    void parse(const std::string& spec) {
+        std::istringstream in(spec);
+        std::string item;
+        while (std::getline(in, item, ',')) {
+            size_t eq = item.find('=');
+            if (eq == std::string::npos) throw std::runtime_error("Bad cost '" + item + "', expected class=cycles");
+            std::string name = item.substr(0, eq);
+            int value = std::atoi(item.c_str() + eq + 1);
+            if (int* slot = find(name)) *slot = value;
+            else throw std::runtime_error("Unknown cost class: " + name);
+        }
+    }
+
+    void print(std::ostream& out) const {
+        out << "alu=" << alu << ",mul=" << mul << ",div=" << div << ",load=" << load << ",store=" << store
+            << ",branch=" << branch << ",taken=" << taken << ",syscall=" << syscall;
+    }
+
+private:
+    int* find(const std::string& name) {
+        if (name == "alu") return &alu;
+        if (name == "mul") return &mul;
+        if (name == "div") return &div;
+        if (name == "load") return &load;
+        if (name == "store") return &store;
+        if (name == "branch") return &branch;
+        if (name == "taken") return &taken;
+        if (name == "syscall") return &syscall;
+        return nullptr;
+    }
+};
+
+struct SimStats {
+    uint64_t calls = 0;
+    uint64_t insns = 0;
+    uint64_t loads = 0;
+    uint64_t stores = 0;
+    uint64_t branches = 0;
+    uint64_t taken = 0;
+    uint64_t cycles = 0;
+};
+
+class Simulator {
+public:
+    static constexpr uint64_t TextBase = 0x400000;
+    static constexpr uint64_t StackTop = 0x7ffff000;
+    static constexpr uint64_t HaltAddress = 0; // x30 awal: ret dari _start berhenti
+
+    uint64_t maxSteps = 1000000000;
+    std::ostream* output = &std::cout; // tujuan syscall write
+
+    // _start membuang nilai kembali main; x0 saat fungsi yang dipanggil
+    // _start kembali disimpan di sini untuk pengecekan hasil.
+    bool hasResult = false;
+    uint64_t result = 0;
+    std::string resultFunction;
+
+    explicit Simulator(const SimCosts& c = SimCosts()) : costs(c) {}
+
+    // Rakit teks assembly; error menyebut baris sumbernya.
+    void assemble(std::istream& in) {
+        std::string raw;
+        int lineNo = 0;
+        Section section = Section::Text;
+        while (std::getline(in, raw)) {
+            ++lineNo;
+            std::string line = trim(stripComment(raw));
+            while (!line.empty()) {
+                size_t colon = labelEnd(line);
+                if (colon == std::string::npos) break;
+                defineLabel(trim(line.substr(0, colon)), section, lineNo);
+                line = trim(line.substr(colon + 1));
+            }
+            if (line.empty()) continue;
+            try {
+                if (line[0] == '.') directive(line, section, lineNo);
+                else if (section == Section::Text) instruction(line, lineNo);
+                else throw std::runtime_error("instruction outside .text");
+            } catch (const std::runtime_error& e) {
+                throw std::runtime_error("line " + std::to_string(lineNo) + ": " + e.what() + " ('" + line + "')");
+            }
+        }
+        link();
+    }
+
+    // Jalankan dari _start sampai exit; hasilnya kode exit program.
+    int run() {
+        std::fill(std::begin(regs), std::end(regs), 0);
+        std::memset(vregs, 0, sizeof vregs);
+        regs[SP] = StackTop;
+        regs[30] = HaltAddress;
+        nzcv = 0;
+        steps = 0;
+        hasResult = false;
+        uint64_t entryReturn = HaltAddress;
+        uint64_t pc = symbol("_start");
+        stats.assign(functions.size(), SimStats());
+        int entryFn = text.empty() ? 0 : text[(pc - TextBase) / 4].fn;
+        ++stats[entryFn].calls;
+
+        while (true) {
+            if (pc == HaltAddress) return (int)(regs[0] & 0xff);
+            uint64_t index = (pc - TextBase) / 4;
+            if (pc < TextBase || pc % 4 != 0 || index >= text.size()) throw fault("pc outside .text", pc);
+            if (++steps > maxSteps) throw std::runtime_error("step limit (" + std::to_string(maxSteps) + ") exceeded");
+
+            const Insn& in = text[index];
+            SimStats& st = stats[in.fn];
+            ++st.insns;
+            uint64_t next = pc + 4;
+
+            switch (in.op) {
+                case Op::Mov: set(in.rd, in.hasImm ? in.imm : get(in.rn, in.w), in.w); st.cycles += costs.alu; break;
+                case Op::Movz: set(in.rd, (uint64_t)in.imm << in.shift, in.w); st.cycles += costs.alu; break;
+                case Op::Movk: {
+                    uint64_t mask = 0xffffULL << in.shift;
+                    set(in.rd, (get(in.rd, in.w) & ~mask) | ((uint64_t)in.imm << in.shift), in.w);
+                    st.cycles += costs.alu;
+                    break;
+                }
+                case Op::Add: set(in.rd, get(in.rn, in.w) + operand(in), in.w); st.cycles += costs.alu; break;
+                case Op::Sub: set(in.rd, get(in.rn, in.w) - operand(in), in.w); st.cycles += costs.alu; break;
+                case Op::Neg: set(in.rd, 0 - operand(in), in.w); st.cycles += costs.alu; break;
+                case Op::Ext: {
+                    int bits = in.size * 8;
+                    uint64_t v = get(in.rn, true) & ((1ULL << bits) - 1);
+                    if (in.sign && (v >> (bits - 1))) v |= ~0ULL << bits;
+                    set(in.rd, v, in.w);
+                    st.cycles += costs.alu;
+                    break;
+                }
+                case Op::And: set(in.rd, get(in.rn, in.w) & operand(in), in.w); st.cycles += costs.alu; break;
+                case Op::Orr: set(in.rd, get(in.rn, in.w) | operand(in), in.w); st.cycles += costs.alu; break;
+                case Op::Eor: set(in.rd, get(in.rn, in.w) ^ operand(in), in.w); st.cycles += costs.alu; break;
+                case Op::Lsl: set(in.rd, get(in.rn, in.w) << (operand(in) & (in.w ? 31 : 63)), in.w); st.cycles += costs.alu; break;
+                case Op::Lsr: set(in.rd, get(in.rn, in.w) >> (operand(in) & (in.w ? 31 : 63)), in.w); st.cycles += costs.alu; break;
+                case Op::Asr: {
+                    int amount = (int)(operand(in) & (in.w ? 31 : 63));
+                    int64_t v = in.w ? (int64_t)(int32_t)get(in.rn, true) : (int64_t)get(in.rn, false);
+                    set(in.rd, (uint64_t)(v >> amount), in.w);
+                    st.cycles += costs.alu;
+                    break;
+                }
+                case Op::Mul: set(in.rd, get(in.rn, in.w) * get(in.rm, in.w), in.w); st.cycles += costs.mul; break;
+                case Op::Madd: set(in.rd, get(in.ra, in.w) + get(in.rn, in.w) * get(in.rm, in.w), in.w); st.cycles += costs.mul; break;
+                case Op::Msub: set(in.rd, get(in.ra, in.w) - get(in.rn, in.w) * get(in.rm, in.w), in.w); st.cycles += costs.mul; break;
+                case Op::Udiv: {
+                    uint64_t d = get(in.rm, in.w);
+                    set(in.rd, d ? get(in.rn, in.w) / d : 0, in.w);
+                    st.cycles += costs.div;
+                    break;
+                }
+                case Op::Sdiv: {
+                    int64_t n = in.w ? (int32_t)get(in.rn, true) : (int64_t)get(in.rn, false);
+                    int64_t d = in.w ? (int32_t)get(in.rm, true) : (int64_t)get(in.rm, false);
+                    int64_t q = d == 0 ? 0 : (d == -1 ? (int64_t)(0 - (uint64_t)n) : n / d);
+                    set(in.rd, (uint64_t)q, in.w);
+                    st.cycles += costs.div;
+                    break;
+                }
+                case Op::Cmp: compare(get(in.rn, in.w), operand(in), in.w); st.cycles += costs.alu; break;
+                case Op::Cset: set(in.rd, condition(in.cond) ? 1 : 0, in.w); st.cycles += costs.alu; break;
+                case Op::Csel: set(in.rd, condition(in.cond) ? get(in.rn, in.w) : get(in.rm, in.w), in.w); st.cycles += costs.alu; break;
+                case Op::Umulh: set(in.rd, (uint64_t)(((unsigned __int128)get(in.rn, false) * get(in.rm, false)) >> 64), false); st.cycles += costs.mul; break;
+                case Op::Smulh: set(in.rd, (uint64_t)(((__int128)(int64_t)get(in.rn, false) * (int64_t)get(in.rm, false)) >> 64), false); st.cycles += costs.mul; break;
+                case Op::Adrp: set(in.rd, in.target & ~0xfffULL, false); st.cycles += costs.alu; break;
+                case Op::Adr: set(in.rd, in.target, false); st.cycles += costs.alu; break;
+                case Op::Word: throw fault("executing data at", pc);
+
+                case Op::B:
+                case Op::Bl:
+                case Op::BCond:
+                case Op::Cbz:
+                case Op::Cbnz:
+                case Op::Br:
+                case Op::Blr:
+                case Op::Ret: {
+                    bool take = true;
+                    uint64_t target = in.target;
+                    if (in.op == Op::BCond) take = condition(in.cond);
+                    else if (in.op == Op::Cbz) take = get(in.rn, in.w) == 0;
+                    else if (in.op == Op::Cbnz) take = get(in.rn, in.w) != 0;
+                    else if (in.op == Op::Br || in.op == Op::Blr || in.op == Op::Ret) target = get(in.rn, false);
+                    if (in.op == Op::Bl || in.op == Op::Blr) {
+                        regs[30] = next;
+                        if (in.fn == entryFn) entryReturn = next;
+                    }
+                    if (in.op == Op::Ret && take && target == entryReturn && entryReturn != HaltAddress) {
+                        hasResult = true;
+                        result = regs[0];
+                    }
+                    ++st.branches;
+                    st.cycles += costs.branch;
+                    if (take) {
+                        ++st.taken;
+                        st.cycles += costs.taken;
+                        next = target;
+                        if ((in.op == Op::Bl || in.op == Op::Blr) && target != HaltAddress) {
+                            uint64_t t = (target - TextBase) / 4;
+                            if (target >= TextBase && t < text.size()) {
+                                ++stats[text[t].fn].calls;
+                                if (in.fn == entryFn) resultFunction = functions[text[t].fn];
+                            }
+                        }
+                    }
+                    break;
+                }
+
+                case Op::Ldr:
+                case Op::Str:
+                case Op::Ldp:
+                case Op::Stp: {
+                    uint64_t base = get(in.rn, false);
+                    uint64_t addr = base;
+                    if (in.rm != ZR) addr += get(in.rm, false) << in.shift;
+                    else if (in.mode != Mode::Post) addr += in.imm;
+                    bool load = in.op == Op::Ldr || in.op == Op::Ldp;
+                    if (in.op == Op::Ldr) {
+                        set(in.rd, extend(read(addr, in.size), in.size, in.sign), in.w);
+                    } else if (in.op == Op::Str) {
+                        write(addr, get(in.rd, in.w), in.size);
+                    } else if (in.op == Op::Ldp) {
+                        uint64_t a = read(addr, in.size), b = read(addr + in.size, in.size);
+                        set(in.rd, a, in.w);
+                        set(in.rt2, b, in.w);
+                    } else {
+                        write(addr, get(in.rd, in.w), in.size);
+                        write(addr + in.size, get(in.rt2, in.w), in.size);
+                    }
+                    if (in.mode == Mode::Pre) set(in.rn, addr, false);
+                    else if (in.mode == Mode::Post) set(in.rn, base + in.imm, false);
+                    if (load) {
+                        ++st.loads;
+                        st.cycles += costs.load;
+                    } else {
+                        ++st.stores;
+                        st.cycles += costs.store;
+                    }
+                    break;
+                }
+
+                case Op::Stxr:
+                case Op::Ldadd:
+                case Op::Cas: {
+                    // rm = ws (status / operand / nilai pembanding), rd = wt.
+                    uint64_t addr = get(in.rn, false);
+                    uint64_t mask = in.size == 8 ? ~0ULL : (1ULL << (in.size * 8)) - 1;
+                    if (in.op == Op::Stxr) {
+                        write(addr, get(in.rd, in.w), in.size);
+                        set(in.rm, 0, true);
+                        ++st.stores;
+                        st.cycles += costs.store;
+                        break;
+                    }
+                    uint64_t old = read(addr, in.size);
+                    uint64_t operandValue = get(in.rm, in.w);
+                    if (in.op == Op::Ldadd) {
+                        write(addr, old + operandValue, in.size);
+                        set(in.rd, old, in.w);
+                    } else {
+                        if (old == (operandValue & mask)) write(addr, get(in.rd, in.w), in.size);
+                        set(in.rm, old, in.w);
+                    }
+                    ++st.loads;
+                    ++st.stores;
+                    st.cycles += costs.load + costs.store;
+                    break;
+                }
+
+                case Op::Svc: {
+                    st.cycles += costs.syscall;
+                    uint64_t nr = regs[8];
+                    if (nr == 93 || nr == 94) return (int)(regs[0] & 0xff);
+                    if (nr != 64) throw fault("unsupported syscall " + std::to_string(nr) + " at", pc);
+                    std::string bytes(regs[2], '\0');
+                    for (uint64_t i = 0; i < regs[2]; ++i) bytes[i] = (char)read(regs[1] + i, 1);
+                    output->write(bytes.data(), bytes.size());
+                    regs[0] = regs[2];
+                    break;
+                }
+                case Op::Nop: st.cycles += costs.alu; break;
+
+                case Op::VLd1:
+                case Op::VSt1: {
+                    uint64_t base = get(in.rn, false);
+                    uint64_t addr = base;
+                    if (in.rm != ZR) addr += get(in.rm, false) << in.shift;
+                    else if (in.mode != Mode::Post) addr += in.imm;
+                    int bytes = in.size * in.lanes;
+                    for (int i = 0; i < bytes; ++i) {
+                        if (in.op == Op::VLd1) vregs[in.rd][i] = (uint8_t)read(addr + i, 1);
+                        else write(addr + i, vregs[in.rd][i], 1);
+                    }
+                    if (in.op == Op::VLd1) {
+                        if (bytes < 16) std::memset(vregs[in.rd] + bytes, 0, 16 - bytes);
+                        ++st.loads;
+                        st.cycles += costs.load;
+                    } else {
+                        ++st.stores;
+                        st.cycles += costs.store;
+                    }
+                    if (in.mode == Mode::Pre) set(in.rn, addr, false);
+                    else if (in.mode == Mode::Post) set(in.rn, base + in.imm, false);
+                    break;
+                }
+                case Op::VAddlv: {
+                    uint64_t sum = 0;
+                    for (int i = 0; i < in.lanes; ++i) sum += lane(in.rn, i, in.size);
+                    std::memset(vregs[in.rd], 0, 16);
+                    std::memcpy(vregs[in.rd], &sum, std::min(in.size * 2, 8));
+                    st.cycles += costs.alu;
+                    break;
+                }
+                case Op::VFmov: set(in.rd, lane(in.rn, 0, in.w ? 4 : 8), in.w); st.cycles += costs.alu; break;
+                case Op::VAdd:
+                case Op::VSub:
+                case Op::VMul:
+                case Op::VUmin:
+                case Op::VUmax:
+                case Op::VDup: {
+                    uint8_t out[16] = {};
+                    for (int i = 0; i < in.lanes; ++i) {
+                        uint64_t a = lane(in.rn, i, in.size), b = lane(in.rm, i, in.size), r;
+                        if (in.op == Op::VAdd) r = a + b;
+                        else if (in.op == Op::VSub) r = a - b;
+                        else if (in.op == Op::VMul) r = a * b;
+                        else if (in.op == Op::VUmin) r = std::min(a, b);
+                        else if (in.op == Op::VUmax) r = std::max(a, b);
+                        else r = get(in.rn, in.w);
+                        std::memcpy(out + i * in.size, &r, in.size);
+                    }
+                    std::memcpy(vregs[in.rd], out, 16);
+                    st.cycles += in.op == Op::VMul ? costs.mul : costs.alu;
+                    break;
+                }
+            }
+            pc = next;
+        }
+    }
+
+    // Tabel per fungsi, diurutkan menurut siklus.
+    void report(std::ostream& out) const {
+        std::vector<size_t> order;
+        SimStats total;
+        for (size_t i = 0; i < stats.size(); ++i) {
+            const SimStats& s = stats[i];
+            if (!s.insns) continue;
+            order.push_back(i);
+            total.calls += s.calls;
+            total.insns += s.insns;
+            total.loads += s.loads;
+            total.stores += s.stores;
+            total.branches += s.branches;
+            total.taken += s.taken;
+            total.cycles += s.cycles;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return stats[a].cycles > stats[b].cycles; });
+
+        size_t width = 8;
+        for (size_t i : order) width = std::max(width, functions[i].size());
+        auto row = [&](const std::string& name, const SimStats& s) {
+            out << std::left << std::setw((int)width) << name << std::right
+                << std::setw(10) << s.calls << std::setw(12) << s.insns << std::setw(10) << s.loads
+                << std::setw(10) << s.stores << std::setw(10) << s.branches << std::setw(10) << s.taken
+                << std::setw(12) << s.cycles << "\n";
+        };
+        out << std::left << std::setw((int)width) << "function" << std::right
+            << std::setw(10) << "calls" << std::setw(12) << "insns" << std::setw(10) << "loads"
+            << std::setw(10) << "stores" << std::setw(10) << "branches" << std::setw(10) << "taken"
+            << std::setw(12) << "cycles" << "\n";
+        for (size_t i : order) row(functions[i], stats[i]);
+        row("total", total);
+        out << "cost model: ";
+        costs.print(out);
+        out << "\n";
+    }
+
+    const std::vector<SimStats>& functionStats() const { return stats; }
+    const std::vector<std::string>& functionNames() const { return functions; }
+
+private:
+    enum class Section { Text, Data };
+    enum class Op {
+        Mov, Movz, Movk, Add, Sub, Neg, Ext, And, Orr, Eor, Lsl, Lsr, Asr,
+        Mul, Madd, Msub, Umulh, Smulh, Udiv, Sdiv, Cmp, Cset, Csel, Adrp,
+        B, Bl, BCond, Cbz, Cbnz, Br, Blr, Ret,
+        Ldr, Str, Ldp, Stp, Svc, Nop, Adr, Word, Stxr, Ldadd, Cas,
+        VLd1, VSt1, VAdd, VSub, VMul, VUmin, VUmax, VDup, VAddlv, VFmov
+    };
+    enum class Mode { Offset, Pre, Post };
+    enum { SP = 31, ZR = 32 };
+
+    struct Insn {
+        Op op = Op::Nop;
+        bool w = false; // operasi 32-bit (register w)
+        int rd = ZR, rn = ZR, rm = ZR, ra = ZR, rt2 = ZR;
+        bool hasImm = false;
+        int64_t imm = 0;
+        int shift = 0;
+        int shiftKind = 0; // operand register: 0 lsl, 1 lsr, 2 asr
+        int size = 8;      // lebar akses memori; vektor: lebar elemen
+        int lanes = 0;     // vektor: jumlah elemen (8 atau 16 byte total)
+        bool sign = false; // ldrs*
+        Mode mode = Mode::Offset;
+        int cond = 0;
+        std::string label; // target branch/adrp, atau :lo12:label
+        bool lo12 = false;
+        uint64_t target = 0;
+        int line = 0;
+        int fn = 0;
+    };
+
+    struct Label {
+        Section section;
+        uint64_t offset;
+        int line;
+    };
+
+    SimCosts costs;
+    std::vector<Insn> text;
+    std::vector<uint8_t> data;
+    uint64_t dataBase = 0;
+    std::map<std::string, Label> labels;
+    std::vector<std::string> functions{"(entry)"}; // label global di .text
+    std::vector<SimStats> stats;
+
+    uint64_t regs[33] = {};
+    uint8_t vregs[32][16] = {}; // v0..v31 (NEON)
+    uint64_t nzcv = 0;
+    uint64_t steps = 0;
+
+    static constexpr uint64_t PageSize = 4096;
+    std::unordered_map<uint64_t, std::unique_ptr<uint8_t[]>> pages;
+    uint64_t lastPage = ~0ULL;
+    uint8_t* lastData = nullptr;
+
+    // ---- perakitan ----
+
+    static std::string stripComment(const std::string& s) {
+        bool quoted = false;
+        for (size_t i = 0; i < s.size(); ++i) {
+            if (s[i] == '"' && (i == 0 || s[i - 1] != '\\')) quoted = !quoted;
+            if (quoted) continue;
+            if (s[i] == ';' || (s[i] == '/' && i + 1 < s.size() && s[i + 1] == '/')) return s.substr(0, i);
+        }
+        return s;
+    }
+
+    static std::string trim(const std::string& s) {
+        size_t b = s.find_first_not_of(" \t\r");
+        if (b == std::string::npos) return "";
+        return s.substr(b, s.find_last_not_of(" \t\r") - b + 1);
+    }
+
+    static std::string lower(std::string s) {
+        for (char& c : s) c = (char)std::tolower((unsigned char)c);
+        return s;
+    }
+
+    // Posisi ':' penutup label di awal baris, atau npos.
+    static size_t labelEnd(const std::string& line) {
+        size_t i = 0;
+        while (i < line.size() && (std::isalnum((unsigned char)line[i]) || line[i] == '_' || line[i] == '.' || line[i] == '$')) ++i;
+        return i > 0 && i < line.size() && line[i] == ':' ? i : std::string::npos;
+    }
+
+    void defineLabel(const std::string& name, Section section, int line) {
+        auto it = labels.find(name);
+        if (it != labels.end())
+            throw std::runtime_error("line " + std::to_string(line) + ": label '" + name + "' already defined at line " + std::to_string(it->second.line));
+        labels[name] = {section, section == Section::Text ? text.size() : data.size(), line};
+        if (section == Section::Text && name.rfind(".L", 0) != 0) functions.push_back(name);
+    }
+
+    void directive(const std::string& line, Section& section, int lineNo) {
+        size_t sp = line.find_first_of(" \t");
+        std::string name = line.substr(0, sp);
+        std::string rest = sp == std::string::npos ? "" : trim(line.substr(sp));
+
+        if (name == ".text") section = Section::Text;
+        else if (name == ".data" || name == ".bss") section = Section::Data;
+        else if (name == ".section") section = rest.rfind(".text", 0) == 0 ? Section::Text : Section::Data;
+        else if (name == ".global" || name == ".globl" || name == ".type" || name == ".size") return;
+        else if (name == ".balign" || name == ".align" || name == ".p2align") {
+            uint64_t n = std::stoull(rest, nullptr, 0);
+            if (name != ".balign") n = 1ULL << n;
+            if (section == Section::Text) return;
+            while (n && data.size() % n) data.push_back(0);
+        } else if (section == Section::Text && (name == ".word" || name == ".long")) {
+            // Tabel lompatan di .text: nilai 32 bit, boleh berupa selisih label.
+            for (auto& item : splitOperands(rest)) {
+                Insn in;
+                in.op = Op::Word;
+                in.label = item;
+                in.line = lineNo;
+                in.fn = (int)functions.size() - 1;
+                text.push_back(in);
+            }
+        } else if (section == Section::Text) {
+            throw std::runtime_error("data directive in .text");
+        } else if (name == ".byte" || name == ".hword" || name == ".short" || name == ".word" || name == ".long" || name == ".quad" || name == ".xword") {
+            int width = name == ".byte" ? 1 : name == ".hword" || name == ".short" ? 2 : name == ".word" || name == ".long" ? 4 : 8;
+            for (auto& item : splitOperands(rest)) {
+                uint64_t v = (uint64_t)std::stoll(item, nullptr, 0);
+                for (int i = 0; i < width; ++i) data.push_back((uint8_t)(v >> (8 * i)));
+            }
+        } else if (name == ".zero" || name == ".space" || name == ".skip") {
+            data.resize(data.size() + std::stoull(rest, nullptr, 0), 0);
+        } else if (name == ".asciz" || name == ".string" || name == ".ascii") {
+            std::string s = unquote(rest);
+            data.insert(data.end(), s.begin(), s.end());
+            if (name != ".ascii") data.push_back(0);
+        } else {
+            throw std::runtime_error("unsupported directive " + name);
+        }
+    }
+
+    static std::string unquote(const std::string& s) {
+        if (s.size() < 2 || s.front() != '"' || s.back() != '"') throw std::runtime_error("expected string literal");
+        std::string out;
+        for (size_t i = 1; i + 1 < s.size(); ++i) {
+            char c = s[i];
+            if (c != '\\' || i + 2 >= s.size()) {
+                out += c;
+                continue;
+            }
+            c = s[++i];
+            switch (c) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case '0': out += '\0'; break;
+                default: out += c; break;
+            }
+        }
+        return out;
+    }
+
+    // Pisah operand pada koma di luar [] dan "".
+    static std::vector<std::string> splitOperands(const std::string& s) {
+        std::vector<std::string> out;
+        std::string cur;
+        int depth = 0;
+        bool quoted = false;
+        for (char c : s) {
+            if (c == '"') quoted = !quoted;
+            if (!quoted && c == '[') ++depth;
+            if (!quoted && c == ']') --depth;
+            if (c == ',' && depth == 0 && !quoted) {
+                out.push_back(trim(cur));
+                cur.clear();
+            } else {
+                cur += c;
+            }
+        }
+        if (!trim(cur).empty()) out.push_back(trim(cur));
+        return out;
+    }
+
+    // xN/wN/sp/xzr -> indeks; w diisi true untuk register 32-bit.
+    static int reg(const std::string& s, bool* w = nullptr) {
+        std::string r = lower(s);
+        bool is32 = false;
+        int index = -1;
+        if (r == "sp") index = SP;
+        else if (r == "wsp") index = SP, is32 = true;
+        else if (r == "xzr") index = ZR;
+        else if (r == "wzr") index = ZR, is32 = true;
+        else if (r == "fp") index = 29;
+        else if (r == "lr") index = 30;
+        else if (r.size() >= 2 && (r[0] == 'x' || r[0] == 'w') && std::all_of(r.begin() + 1, r.end(), ::isdigit)) {
+            index = std::stoi(r.substr(1));
+            is32 = r[0] == 'w';
+            if (index > 30) index = -1;
+        }
+        if (index < 0) throw std::runtime_error("bad register '" + s + "'");
+        if (w) *w = is32;
+        return index;
+    }
+
+    static bool isReg(const std::string& s) {
+        try {
+            reg(s);
+            return true;
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+    }
+
+    static int64_t immediate(const std::string& s) {
+        std::string v = s[0] == '#' ? s.substr(1) : s;
+        size_t used = 0;
+        int64_t value = (int64_t)std::stoull(v[0] == '-' ? v.substr(1) : v, &used, 0);
+        if (used != v.size() - (v[0] == '-' ? 1 : 0)) throw std::runtime_error("bad immediate '" + s + "'");
+        return v[0] == '-' ? -value : value;
+    }
+
+    // "lsl #n" -> n; kind diisi 0 lsl, 1 lsr, 2 asr.
+    static int shiftAmount(const std::string& s, int* kind = nullptr) {
+        std::string l = lower(s);
+        int k = l.rfind("lsl", 0) == 0 ? 0 : l.rfind("lsr", 0) == 0 ? 1 : l.rfind("asr", 0) == 0 ? 2 : -1;
+        if (k < 0 || (k && !kind)) throw std::runtime_error("unsupported shift '" + s + "'");
+        if (kind) *kind = k;
+        return (int)immediate(trim(l.substr(3)));
+    }
+
+    static int conditionCode(const std::string& s) {
+        static const char* names[] = {"eq", "ne", "hs", "lo", "mi", "pl", "vs", "vc", "hi", "ls", "ge", "lt", "gt", "le", "al"};
+        std::string c = lower(s);
+        if (c == "cs") c = "hs";
+        if (c == "cc") c = "lo";
+        for (int i = 0; i < 15; ++i) if (c == names[i]) return i;
+        throw std::runtime_error("bad condition '" + s + "'");
+    }
+
+    void expect(const std::vector<std::string>& ops, size_t n) {
+        if (ops.size() != n) throw std::runtime_error("expected " + std::to_string(n) + " operand(s)");
+    }
+
+    // Operand kedua ALU: #imm, register, atau register dengan lsl.
+    void secondOperand(Insn& in, const std::vector<std::string>& ops, size_t i) {
+        if (ops[i][0] == '#' || ops[i][0] == '-' || std::isdigit((unsigned char)ops[i][0])) {
+            in.hasImm = true;
+            in.imm = immediate(ops[i]);
+            if (i + 1 < ops.size()) in.imm <<= shiftAmount(ops[i + 1]);
+        } else if (ops[i].rfind(":lo12:", 0) == 0) {
+            in.lo12 = true;
+            in.label = ops[i].substr(6);
+        } else {
+            in.rm = reg(ops[i]);
+            if (i + 1 < ops.size()) in.shift = shiftAmount(ops[i + 1], &in.shiftKind);
+        }
+    }
+
+    // [base], [base, #off], [base, xM{, lsl #s}], diikuti ! atau , #post.
+    void memoryOperand(Insn& in, const std::vector<std::string>& ops, size_t i) {
+        if (i >= ops.size()) throw std::runtime_error("missing memory operand");
+        std::string m = ops[i];
+        bool pre = !m.empty() && m.back() == '!';
+        if (pre) m = trim(m.substr(0, m.size() - 1));
+        if (m.size() < 2 || m.front() != '[' || m.back() != ']') throw std::runtime_error("bad memory operand '" + ops[i] + "'");
+        auto parts = splitOperands(m.substr(1, m.size() - 2));
+        if (parts.empty()) throw std::runtime_error("bad memory operand '" + ops[i] + "'");
+        in.rn = reg(parts[0]);
+        if (parts.size() >= 2) {
+            if (isReg(parts[1])) {
+                in.rm = reg(parts[1]);
+                if (parts.size() == 3) in.shift = shiftAmount(parts[2]);
+            } else {
+                in.imm = immediate(parts[1]);
+            }
+        }
+        if (pre) in.mode = Mode::Pre;
+        if (i + 1 < ops.size()) {
+            in.mode = Mode::Post;
+            in.imm = immediate(ops[i + 1]);
+        }
+    }
+
+    // vN.16b/8b/8h/4h/4s/2s/2d -> indeks; esize/lanes diisi dari susunannya.
+    static int vectorReg(const std::string& s, int* esize = nullptr, int* lanes = nullptr) {
+        std::string r = lower(s);
+        size_t dot = r.find('.');
+        if (r.size() < 4 || r[0] != 'v' || dot == std::string::npos || dot < 2 ||
+            !std::all_of(r.begin() + 1, r.begin() + dot, ::isdigit))
+            throw std::runtime_error("bad vector register '" + s + "'");
+        int index = std::stoi(r.substr(1, dot - 1));
+        std::string t = r.substr(dot + 1);
+        int n = t.size() >= 2 && std::isdigit((unsigned char)t[0]) ? std::stoi(t) : 0;
+        char k = t.empty() ? 0 : t.back();
+        int e = k == 'b' ? 1 : k == 'h' ? 2 : k == 's' ? 4 : k == 'd' ? 8 : 0;
+        if (index > 31 || !e || (n * e != 8 && n * e != 16)) throw std::runtime_error("bad vector register '" + s + "'");
+        if (esize) *esize = e;
+        if (lanes) *lanes = n;
+        return index;
+    }
+
+    static bool isVectorReg(const std::string& s) {
+        try {
+            vectorReg(s);
+            return true;
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+    }
+
+    // Register SIMD skalar bN/hN/sN/dN/qN -> indeks; size diisi lebarnya.
+    static int scalarReg(const std::string& s, int* size = nullptr) {
+        std::string r = lower(s);
+        int e = r.empty() ? 0 : r[0] == 'b' ? 1 : r[0] == 'h' ? 2 : r[0] == 's' ? 4 : r[0] == 'd' ? 8 : r[0] == 'q' ? 16 : 0;
+        if (!e || r.size() < 2 || r.size() > 3 || !std::all_of(r.begin() + 1, r.end(), ::isdigit) || std::stoi(r.substr(1)) > 31)
+            throw std::runtime_error("bad SIMD register '" + s + "'");
+        if (size) *size = e;
+        return std::stoi(r.substr(1));
+    }
+
+    static bool isScalarReg(const std::string& s) {
+        try {
+            scalarReg(s);
+            return true;
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+    }
+
+    // ld1/st1 {vN.T}, [xN]{, #post}; ldr/str qN, [..]; add/sub/mul/umin/umax
+    // vD.T, vN.T, vM.T; dup vD.T, wN; uaddlv hD/sD/dD, vN.T; fmov wD/xD, sN/dN.
+    void vectorInstruction(Insn& in, const std::string& mn, const std::vector<std::string>& ops) {
+        if (mn == "ldr" || mn == "str") {
+            int size = 0;
+            in.op = mn == "ldr" ? Op::VLd1 : Op::VSt1;
+            in.rd = scalarReg(ops.at(0), &size);
+            if (size != 16) throw std::runtime_error("only q registers can be loaded or stored");
+            in.size = 1;
+            in.lanes = 16;
+            memoryOperand(in, ops, 1);
+        } else if (mn == "ld1" || mn == "st1") {
+            std::string list = ops.at(0);
+            if (list.size() < 2 || list.front() != '{' || list.back() != '}') throw std::runtime_error("expected {vN.T}");
+            in.op = mn == "ld1" ? Op::VLd1 : Op::VSt1;
+            in.rd = vectorReg(trim(list.substr(1, list.size() - 2)), &in.size, &in.lanes);
+            memoryOperand(in, ops, 1);
+            if (in.mode == Mode::Pre || in.rm != ZR || (in.mode == Mode::Offset && in.imm)) throw std::runtime_error("unsupported ld1/st1 addressing");
+        } else if (mn == "dup") {
+            expect(ops, 2);
+            in.op = Op::VDup;
+            in.rd = vectorReg(ops[0], &in.size, &in.lanes);
+            in.rn = reg(ops[1], &in.w);
+        } else if (mn == "uaddlv") {
+            expect(ops, 2);
+            int size = 0;
+            in.op = Op::VAddlv;
+            in.rd = scalarReg(ops[0], &size);
+            in.rn = vectorReg(ops[1], &in.size, &in.lanes);
+            if (size != in.size * 2 || size > 8) throw std::runtime_error("uaddlv result must be twice the element width");
+        } else if (mn == "fmov") {
+            expect(ops, 2);
+            int size = 0;
+            in.op = Op::VFmov;
+            in.rd = reg(ops[0], &in.w);
+            in.rn = scalarReg(ops[1], &size);
+            if (size != (in.w ? 4 : 8)) throw std::runtime_error("fmov register widths differ");
+        } else if (mn == "add" || mn == "sub" || mn == "mul" || mn == "umin" || mn == "umax") {
+            expect(ops, 3);
+            in.op = mn == "add" ? Op::VAdd : mn == "sub" ? Op::VSub : mn == "mul" ? Op::VMul : mn == "umin" ? Op::VUmin : Op::VUmax;
+            in.rd = vectorReg(ops[0], &in.size, &in.lanes);
+            in.rn = vectorReg(ops[1]);
+            in.rm = vectorReg(ops[2]);
+            if (in.op != Op::VAdd && in.op != Op::VSub && in.size == 8) throw std::runtime_error(mn + " has no .2d form");
+        } else {
+            throw std::runtime_error("unsupported vector instruction '" + mn + "'");
+        }
+    }
+
+    void instruction(const std::string& line, int lineNo) {
+        size_t sp = line.find_first_of(" \t");
+        std::string mn = lower(line.substr(0, sp));
+        auto ops = splitOperands(sp == std::string::npos ? "" : trim(line.substr(sp)));
+        Insn in;
+        in.line = lineNo;
+        in.fn = (int)functions.size() - 1;
+
+        if (mn == "ld1" || mn == "st1" || mn == "uaddlv" || mn == "fmov" ||
+            (!ops.empty() && (isVectorReg(ops[0]) || ((mn == "ldr" || mn == "str") && isScalarReg(ops[0]))))) {
+            vectorInstruction(in, mn, ops);
+            text.push_back(in);
+            return;
+        }
+
+        static const std::unordered_map<std::string, Op> alu3 = {
+            {"add", Op::Add}, {"sub", Op::Sub}, {"and", Op::And}, {"orr", Op::Orr}, {"eor", Op::Eor},
+            {"lsl", Op::Lsl}, {"lsr", Op::Lsr}, {"asr", Op::Asr},
+            {"mul", Op::Mul}, {"umulh", Op::Umulh}, {"smulh", Op::Smulh}, {"udiv", Op::Udiv}, {"sdiv", Op::Sdiv},
+        };
+        static const std::unordered_map<std::string, std::pair<int, bool>> loads = {
+            {"ldr", {0, false}}, {"ldrb", {1, false}}, {"ldrh", {2, false}},
+            {"ldrsb", {1, true}}, {"ldrsh", {2, true}}, {"ldrsw", {4, true}},
+            {"ldar", {0, false}}, {"ldarb", {1, false}}, {"ldarh", {2, false}},
+            {"ldxr", {0, false}}, {"ldxrb", {1, false}}, {"ldxrh", {2, false}},
+            {"ldaxr", {0, false}}, {"ldaxrb", {1, false}}, {"ldaxrh", {2, false}},
+        };
+        static const std::unordered_map<std::string, int> stores = {
+            {"str", 0}, {"strb", 1}, {"strh", 2}, {"stlr", 0}, {"stlrb", 1}, {"stlrh", 2},
+        };
+        // Atomik: stxr/stlxr ws, wt, [xn]; ldadd*/cas* ws, wt, [xn]. Simulator
+        // berjalan satu thread, jadi store-exclusive selalu berhasil.
+        static const std::unordered_map<std::string, std::pair<Op, int>> atomics = {
+            {"stxr", {Op::Stxr, 0}}, {"stxrb", {Op::Stxr, 1}}, {"stxrh", {Op::Stxr, 2}},
+            {"stlxr", {Op::Stxr, 0}}, {"stlxrb", {Op::Stxr, 1}}, {"stlxrh", {Op::Stxr, 2}},
+            {"ldadd", {Op::Ldadd, 0}}, {"ldaddb", {Op::Ldadd, 1}}, {"ldaddh", {Op::Ldadd, 2}},
+            {"ldadda", {Op::Ldadd, 0}}, {"ldaddab", {Op::Ldadd, 1}}, {"ldaddah", {Op::Ldadd, 2}},
+            {"ldaddl", {Op::Ldadd, 0}}, {"ldaddlb", {Op::Ldadd, 1}}, {"ldaddlh", {Op::Ldadd, 2}},
+            {"ldaddal", {Op::Ldadd, 0}}, {"ldaddalb", {Op::Ldadd, 1}}, {"ldaddalh", {Op::Ldadd, 2}},
+            {"cas", {Op::Cas, 0}}, {"casb", {Op::Cas, 1}}, {"cash", {Op::Cas, 2}},
+            {"casa", {Op::Cas, 0}}, {"casab", {Op::Cas, 1}}, {"casah", {Op::Cas, 2}},
+            {"casl", {Op::Cas, 0}}, {"caslb", {Op::Cas, 1}}, {"caslh", {Op::Cas, 2}},
+            {"casal", {Op::Cas, 0}}, {"casalb", {Op::Cas, 1}}, {"casalh", {Op::Cas, 2}},
+        };
+
+        auto a3 = alu3.find(mn);
+        auto ld = loads.find(mn);
+        auto stIt = stores.find(mn);
+        auto atom = atomics.find(mn);
+        if (a3 != alu3.end()) {
+            if (ops.size() < 3 || ops.size() > 4) throw std::runtime_error("expected 3 operands");
+            in.op = a3->second;
+            in.rd = reg(ops[0], &in.w);
+            in.rn = reg(ops[1]);
+            if (in.op == Op::Mul || in.op == Op::Umulh || in.op == Op::Smulh || in.op == Op::Udiv || in.op == Op::Sdiv) in.rm = reg(ops[2]);
+            else secondOperand(in, ops, 2);
+        } else if (mn == "mov") {
+            expect(ops, 2);
+            in.op = Op::Mov;
+            in.rd = reg(ops[0], &in.w);
+            if (isReg(ops[1])) {
+                in.rn = reg(ops[1]);
+            } else {
+                in.hasImm = true;
+                in.imm = immediate(ops[1]);
+            }
+        } else if (mn == "movz" || mn == "movk") {
+            in.op = mn == "movz" ? Op::Movz : Op::Movk;
+            in.rd = reg(ops.at(0), &in.w);
+            in.imm = immediate(ops.at(1));
+            if (ops.size() == 3) in.shift = shiftAmount(ops[2]);
+        } else if (mn == "neg") {
+            expect(ops, 2);
+            in.op = Op::Neg;
+            in.rd = reg(ops[0], &in.w);
+            secondOperand(in, ops, 1);
+        } else if (mn == "uxtb" || mn == "uxth" || mn == "sxtb" || mn == "sxth" || mn == "sxtw") {
+            // Zero/sign-extend byte, halfword atau word dari register w.
+            expect(ops, 2);
+            in.op = Op::Ext;
+            in.rd = reg(ops[0], &in.w);
+            in.rn = reg(ops[1]);
+            in.size = mn.back() == 'b' ? 1 : mn.back() == 'h' ? 2 : 4;
+            in.sign = mn[0] == 's';
+        } else if (mn == "madd" || mn == "msub") {
+            expect(ops, 4);
+            in.op = mn == "madd" ? Op::Madd : Op::Msub;
+            in.rd = reg(ops[0], &in.w);
+            in.rn = reg(ops[1]);
+            in.rm = reg(ops[2]);
+            in.ra = reg(ops[3]);
+        } else if (mn == "cmp") {
+            if (ops.size() < 2) throw std::runtime_error("expected 2 operands");
+            in.op = Op::Cmp;
+            in.rn = reg(ops[0], &in.w);
+            secondOperand(in, ops, 1);
+        } else if (mn == "cset") {
+            expect(ops, 2);
+            in.op = Op::Cset;
+            in.rd = reg(ops[0], &in.w);
+            in.cond = conditionCode(ops[1]);
+        } else if (mn == "csel") {
+            expect(ops, 4);
+            in.op = Op::Csel;
+            in.rd = reg(ops[0], &in.w);
+            in.rn = reg(ops[1]);
+            in.rm = reg(ops[2]);
+            in.cond = conditionCode(ops[3]);
+        } else if (mn == "adr") {
+            expect(ops, 2);
+            in.op = Op::Adr;
+            in.rd = reg(ops[0]);
+            in.label = ops[1];
+        } else if (mn == "adrp") {
+            expect(ops, 2);
+            in.op = Op::Adrp;
+            in.rd = reg(ops[0]);
+            in.label = ops[1];
+        } else if (mn == "b" || mn == "bl") {
+            expect(ops, 1);
+            in.op = mn == "b" ? Op::B : Op::Bl;
+            in.label = ops[0];
+        } else if (mn.rfind("b.", 0) == 0) {
+            expect(ops, 1);
+            in.op = Op::BCond;
+            in.cond = conditionCode(mn.substr(2));
+            in.label = ops[0];
+        } else if (mn == "cbz" || mn == "cbnz") {
+            expect(ops, 2);
+            in.op = mn == "cbz" ? Op::Cbz : Op::Cbnz;
+            in.rn = reg(ops[0], &in.w);
+            in.label = ops[1];
+        } else if (mn == "br" || mn == "blr") {
+            expect(ops, 1);
+            in.op = mn == "br" ? Op::Br : Op::Blr;
+            in.rn = reg(ops[0]);
+        } else if (mn == "ret") {
+            in.op = Op::Ret;
+            in.rn = ops.empty() ? 30 : reg(ops[0]);
+        } else if (ld != loads.end() || stIt != stores.end()) {
+            in.op = ld != loads.end() ? Op::Ldr : Op::Str;
+            in.rd = reg(ops.at(0), &in.w);
+            int size = ld != loads.end() ? ld->second.first : stIt->second;
+            in.sign = ld != loads.end() && ld->second.second;
+            in.size = size ? size : (in.w ? 4 : 8);
+            memoryOperand(in, ops, 1);
+        } else if (atom != atomics.end()) {
+            expect(ops, 3);
+            in.op = atom->second.first;
+            in.rd = reg(ops[1], &in.w);
+            in.size = atom->second.second ? atom->second.second : (in.w ? 4 : 8);
+            memoryOperand(in, ops, 2);
+            if (in.mode != Mode::Offset || in.imm || in.rm != ZR) throw std::runtime_error(mn + " takes a plain [xN] address");
+            in.rm = reg(ops[0]);
+        } else if (mn == "ldp" || mn == "stp") {
+            in.op = mn == "ldp" ? Op::Ldp : Op::Stp;
+            in.rd = reg(ops.at(0), &in.w);
+            in.rt2 = reg(ops.at(1));
+            in.size = in.w ? 4 : 8;
+            memoryOperand(in, ops, 2);
+        } else if (mn == "svc") {
+            in.op = Op::Svc;
+        } else if (mn == "nop" || mn == "dmb" || mn == "clrex") {
+            in.op = Op::Nop;
+        } else {
+            throw std::runtime_error("unsupported instruction '" + mn + "'");
+        }
+        text.push_back(in);
+    }
+
+    uint64_t address(const Label& l) const {
+        return l.section == Section::Text ? TextBase + 4 * l.offset : dataBase + l.offset;
+    }
+
+    uint64_t symbol(const std::string& name) const {
+        auto it = labels.find(name);
+        if (it == labels.end()) throw std::runtime_error("undefined symbol '" + name + "'");
+        return address(it->second);
+    }
+
+    // "a - b + 4": angka atau label, dijumlahkan dengan tanda.
+    uint64_t expression(const std::string& expr) const {
+        uint64_t total = 0;
+        size_t pos = 0;
+        bool negative = false;
+        while (pos < expr.size()) {
+            size_t end = expr.find_first_of("+-", pos == 0 ? 0 : pos);
+            if (end == pos) {
+                negative = expr[pos] == '-';
+                ++pos;
+                continue;
+            }
+            std::string term = trim(expr.substr(pos, end == std::string::npos ? std::string::npos : end - pos));
+            uint64_t value = std::isdigit((unsigned char)term[0]) ? std::stoull(term, nullptr, 0) : symbol(term);
+            total = negative ? total - value : total + value;
+            if (end == std::string::npos) break;
+            pos = end;
+        }
+        return total;
+    }
+
+    // Data diletakkan setelah .text; label dan :lo12: diselesaikan di sini.
+    void link() {
+        dataBase = (TextBase + 4 * text.size() + 0xffff) & ~0xffffULL;
+        for (size_t i = 0; i < data.size(); ++i) write(dataBase + i, data[i], 1);
+        for (size_t i = 0; i < text.size(); ++i) {
+            Insn& in = text[i];
+            if (in.label.empty()) continue;
+            try {
+                in.target = in.op == Op::Word ? expression(in.label) : symbol(in.label);
+            } catch (const std::exception& e) {
+                throw std::runtime_error("line " + std::to_string(in.line) + ": " + e.what());
+            }
+            if (in.op == Op::Word) write(TextBase + 4 * i, in.target, 4);
+            if (in.lo12) {
+                in.hasImm = true;
+                in.imm = (int64_t)(in.target & 0xfff);
+            }
+        }
+        stats.assign(functions.size(), SimStats());
+    }
+
+    // ---- eksekusi ----
+
+    uint64_t get(int r, bool w) const {
+        if (r == ZR) return 0;
+        return w ? (uint32_t)regs[r] : regs[r];
+    }
+
+    void set(int r, uint64_t v, bool w) {
+        if (r == ZR) return;
+        regs[r] = w ? (uint32_t)v : v;
+    }
+
+    // Elemen ke-i register vektor v (tanpa tanda).
+    uint64_t lane(int v, int i, int esize) const {
+        if (v == ZR) return 0;
+        uint64_t x = 0;
+        std::memcpy(&x, vregs[v] + i * esize, esize);
+        return x;
+    }
+
+    uint64_t operand(const Insn& in) const {
+        if (in.hasImm) return (uint64_t)in.imm;
+        uint64_t v = get(in.rm, in.w);
+        if (in.shiftKind == 1) return v >> in.shift;
+        if (in.shiftKind == 2) return in.w ? (uint64_t)(uint32_t)((int32_t)v >> in.shift) : (uint64_t)((int64_t)v >> in.shift);
+        return in.w ? (uint32_t)(v << in.shift) : v << in.shift;
+    }
+
+    void compare(uint64_t a, uint64_t b, bool w) {
+        uint64_t r = a - b;
+        bool n, z, c, v;
+        if (w) {
+            uint32_t a32 = (uint32_t)a, b32 = (uint32_t)b, r32 = (uint32_t)r;
+            n = (int32_t)r32 < 0;
+            z = r32 == 0;
+            c = a32 >= b32;
+            v = (((a32 ^ b32) & (a32 ^ r32)) >> 31) != 0;
+        } else {
+            n = (int64_t)r < 0;
+            z = r == 0;
+            c = a >= b;
+            v = (((a ^ b) & (a ^ r)) >> 63) != 0;
+        }
+        nzcv = (n << 3) | (z << 2) | (c << 1) | (uint64_t)v;
+    }
+
+    bool condition(int cond) const {
+        bool n = nzcv & 8, z = nzcv & 4, c = nzcv & 2, v = nzcv & 1;
+        switch (cond) {
+            case 0: return z;
+            case 1: return !z;
+            case 2: return c;
+            case 3: return !c;
+            case 4: return n;
+            case 5: return !n;
+            case 6: return v;
+            case 7: return !v;
+            case 8: return c && !z;
+            case 9: return !c || z;
+            case 10: return n == v;
+            case 11: return n != v;
+            case 12: return !z && n == v;
+            case 13: return z || n != v;
+            default: return true;
+        }
+    }
+
+    static uint64_t extend(uint64_t v, int size, bool sign) {
+        if (!sign || size == 8) return v;
+        int bits = size * 8;
+        return (uint64_t)((int64_t)(v << (64 - bits)) >> (64 - bits));
+    }
+
+    uint8_t* page(uint64_t addr) {
+        uint64_t p = addr / PageSize;
+        if (p == lastPage) return lastData;
+        auto& slot = pages[p];
+        if (!slot) {
+            slot.reset(new uint8_t[PageSize]);
+            std::memset(slot.get(), 0, PageSize);
+        }
+        lastPage = p;
+        lastData = slot.get();
+        return lastData;
+    }
+
+    uint64_t read(uint64_t addr, int size) {
+        uint64_t v = 0;
+        if (addr % PageSize + size <= PageSize) {
+            std::memcpy(&v, page(addr) + addr % PageSize, size);
+            return v;
+        }
+        for (int i = 0; i < size; ++i) v |= (uint64_t)page(addr + i)[(addr + i) % PageSize] << (8 * i);
+        return v;
+    }
+
+    void write(uint64_t addr, uint64_t v, int size) {
+        if (addr % PageSize + size <= PageSize) {
+            std::memcpy(page(addr) + addr % PageSize, &v, size);
+            return;
+        }
+        for (int i = 0; i < size; ++i) page(addr + i)[(addr + i) % PageSize] = (uint8_t)(v >> (8 * i));
+    }
+
+    std::runtime_error fault(const std::string& what, uint64_t pc) const {
+        std::ostringstream msg;
+        msg << what << " 0x" << std::hex << pc;
+        uint64_t index = (pc - TextBase) / 4;
+        if (pc >= TextBase && index < text.size()) msg << std::dec << " (line " << text[index].line << ")";
+        return std::runtime_error(msg.str());
+    }
+};
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef SRA_HPP
+#define SRA_HPP
+
+#include "ast.hpp"
+#include "layout.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+
+// Pecah lokal struct yang tidak bocor menjadi satu lokal per field (scalar
+// replacement of aggregates). Syarat: dideklarasikan dengan literal struct,
+// semua field skalar, dan lokalnya hanya dipakai sebagai s.f (baca atau
+// tulis) -- tidak diambil alamatnya, tidak dikirim ke fungsi, dikembalikan,
+// disalin utuh atau disebut di inj. Field lalu menjadi lokal biasa yang bisa
+// tinggal di register, tanpa blok stack untuk struct-nya.
+class ScalarReplacement {
+    LayoutEngine& layouts;
+    TypeTable& types;
+    std::unordered_map<int, std::shared_ptr<DeclStmtNode>> candidates; // lokal struct -> deklarasinya
+    std::unordered_map<int, std::vector<int>> fieldLocals;             // lokal struct -> lokal per field
+
+public:
+    int split = 0; // lokal struct yang dipecah
+
+    explicit ScalarReplacement(LayoutEngine& l) : layouts(l), types(l.typeTable()) {}
+
+    void run(FunctionDefNode& fn) {
+        collect(fn.body);
+        if (candidates.empty()) return;
+        scan(fn.body);
+        if (candidates.empty()) return;
+        for (auto& [local, decl] : candidates) {
+            auto& ids = fieldLocals[local];
+            for (size_t i = 0; i < layouts.layoutOf(decl->type).fields.size(); ++i) ids.push_back(fn.localCount++);
+        }
+        rewrite(fn.body);
+        split = (int)candidates.size();
+    }
+
+private:
+    void collect(const NodePtr& node) {
+        if (auto d = std::dynamic_pointer_cast<DeclStmtNode>(node)) {
+            auto init = std::dynamic_pointer_cast<StructInitNode>(d->expr);
+            if (init && types.isStruct(d->type) && types.same(init->resolvedType, d->type)) {
+                const StructLayout& layout = layouts.layoutOf(d->type);
+                bool scalar = !layout.fields.empty() && init->args.size() <= layout.fields.size();
+                for (auto& f : layout.fields) {
+                    if (types.isStruct(f.type) || types.isArray(f.type)) scalar = false;
+                }
+                if (scalar) candidates[d->local] = d;
+            }
+        }
+        visitChildren(node, [this](const NodePtr& c) { collect(c); });
+    }
+
+    static int rootLocal(const NodePtr& expr) {
+        if (auto v = std::dynamic_pointer_cast<VarRefNode>(expr)) return v->local;
+        if (auto m = std::dynamic_pointer_cast<MemberAccessNode>(expr)) return rootLocal(m->object);
+        if (auto ai = std::dynamic_pointer_cast<ArrayIndexNode>(expr)) return rootLocal(ai->array);
+        return -1;
+    }
+
+    void escape(const NodePtr& node) {
+        if (auto v = std::dynamic_pointer_cast<VarRefNode>(node)) candidates.erase(v->local);
+        visitChildren(node, [this](const NodePtr& c) { escape(c); });
+    }
+
+    // Lokal kandidat yang muncul selain sebagai objek s.f dianggap bocor.
+    void scan(const NodePtr& node) {
+        switch (node->kind) {
+            case NodeKind::VarRef:
+                candidates.erase(std::static_pointer_cast<VarRefNode>(node)->local);
+                return;
+            case NodeKind::MemberAccess: {
+                auto m = std::static_pointer_cast<MemberAccessNode>(node);
+                if (m->object->kind == NodeKind::VarRef) return;
+                break;
+            }
+            case NodeKind::UnaryOp: {
+                auto u = std::static_pointer_cast<UnaryOpNode>(node);
+                if (u->op == "&") candidates.erase(rootLocal(u->rhs));
+                break;
+            }
+            case NodeKind::Inj:
+                escape(node);
+                return;
+            default: break;
+        }
+        visitChildren(node, [this](const NodePtr& c) { scan(c); });
+    }
+
+    std::shared_ptr<VarRefNode> fieldRef(const std::shared_ptr<VarRefNode>& v, const std::string& field, int index, TypeId type) {
+        auto r = std::make_shared<VarRefNode>(v->name + "." + field, v->line);
+        r->column = v->column;
+        r->local = fieldLocals[v->local][index];
+        r->resolvedType = type;
+        return r;
+    }
+
+    void rewrite(NodePtr& node) {
+        if (auto m = std::dynamic_pointer_cast<MemberAccessNode>(node)) {
+            auto v = std::dynamic_pointer_cast<VarRefNode>(m->object);
+            if (v && candidates.count(v->local)) {
+                const auto& fields = layouts.layoutOf(candidates[v->local]->type).fields;
+                for (size_t i = 0; i < fields.size(); ++i) {
+                    if (fields[i].name == m->field) {
+                        node = fieldRef(v, m->field, (int)i, m->resolvedType);
+                        return;
+                    }
+                }
+            }
+        }
+        if (auto block = std::dynamic_pointer_cast<BlockNode>(node)) {
+            NodeList<Node> out;
+            for (auto& stmt : block->statements) {
+                rewrite(stmt);
+                auto d = std::dynamic_pointer_cast<DeclStmtNode>(stmt);
+                if (!d || !candidates.count(d->local)) {
+                    out.push_back(stmt);
+                    continue;
+                }
+                // Argumen dievaluasi berurutan seperti di literal aslinya; field
+                // tanpa nilai diisi nol.
+                auto init = std::static_pointer_cast<StructInitNode>(d->expr);
+                const auto& fields = layouts.layoutOf(d->type).fields;
+                for (size_t i = 0; i < fields.size(); ++i) {
+                    NodePtr value;
+                    if (i < init->args.size()) {
+                        value = init->args[i];
+                    } else {
+                        value = std::make_shared<LiteralNode>(types.kind(fields[i].type) == TypeKind::Bool ? "false" : "0", d->line);
+                        value->resolvedType = fields[i].type;
+                    }
+                    // Lokal field bertipe field-nya: storeLocal memotong tiap
+                    // tulisan ke lebar field, sama seperti strb/strh ke struct.
+                    auto field = std::make_shared<DeclStmtNode>(d->name + "." + fields[i].name, fields[i].type, value);
+                    field->line = d->line;
+                    field->column = d->column;
+                    field->local = fieldLocals[d->local][i];
+                    out.push_back(field);
+                }
+            }
+            block->statements = std::move(out);
+            return;
+        }
+        visitChildren(node, [this](NodePtr& c) { rewrite(c); });
+    }
+};
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef SYMBOLS_HPP
+#define SYMBOLS_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+using SymbolId = int;
+
+// Nama identifier -> id kecil; string hanya di-hash sekali per node.
+class Interner {
+    std::unordered_map<std::string, SymbolId> ids;
+    std::vector<std::string> names;
+
+public:
+    SymbolId intern(const std::string& name) {
+        auto it = ids.find(name);
+        if (it != ids.end()) return it->second;
+        SymbolId id = (SymbolId)names.size();
+        ids.emplace(name, id);
+        names.push_back(name);
+        return id;
+    }
+
+    // Tanpa menambah entri baru; -1 jika belum pernah di-intern.
+    SymbolId find(const std::string& name) const {
+        auto it = ids.find(name);
+        return it == ids.end() ? -1 : it->second;
+    }
+
+    const std::string& name(SymbolId id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+};
+
+// Tabel simbol bertingkat: tiap symbol menunjuk entri terdalamnya, dan
+// entri yang tertutup scope baru dipulihkan saat scope itu di-pop.
+template<typename Info>
+class ScopedSymbolTable {
+    struct Entry {
+        SymbolId id;
+        Info info;
+        int shadowed;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<int> innermost;
+    std::vector<size_t> scopeStarts;
+
+public:
+    void reset(size_t symbolCount) {
+        entries.clear();
+        scopeStarts.clear();
+        innermost.assign(symbolCount, -1);
+    }
+
+    void pushScope() { scopeStarts.push_back(entries.size()); }
+
+    void popScope() {
+        size_t start = scopeStarts.back();
+        scopeStarts.pop_back();
+        while (entries.size() > start) {
+            innermost[entries.back().id] = entries.back().shadowed;
+            entries.pop_back();
+        }
+    }
+
+    // false jika nama sudah dideklarasikan di scope yang sama.
+    bool declare(SymbolId id, const Info& info) {
+        if ((size_t)id >= innermost.size()) innermost.resize(id + 1, -1);
+        int current = innermost[id];
+        if (current >= 0 && !scopeStarts.empty() && (size_t)current >= scopeStarts.back()) return false;
+        entries.push_back({id, info, current});
+        innermost[id] = (int)entries.size() - 1;
+        return true;
+    }
+
+    const Info* lookup(SymbolId id) const {
+        if (id < 0 || (size_t)id >= innermost.size() || innermost[id] < 0) return nullptr;
+        return &entries[innermost[id]].info;
+    }
+};
+
+#endif
@@ -0,0 +1,34 @@
+#!/bin/bash
+# Regresi codegen: kompilasi tiap tests/sim/*.q, jalankan di quesim, lalu
+# bandingkan keluaran stderr-nya (kode exit, nilai main, profil per fungsi)
+# dengan file .expected di sebelahnya.
+# UPDATE=1 tests/run.sh menulis ulang .expected setelah perubahan yang disengaja.
+root=$(cd "$(dirname "$0")/.." && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+g++ -std=c++17 -pthread "$root/main.cpp" -o "$work/quelang" || exit 1
+g++ -std=c++17 -O2 "$root/quesim.cpp" -o "$work/quesim" || exit 1
+
+fail=0
+for q in "$root"/tests/sim/*.q; do
+    name=$(basename "$q" .q)
+    expected="${q%.q}.expected"
+    if ! "$work/quelang" "$q" "$work/$name.s" > "$work/$name.log" 2>&1; then
+        echo "FAIL $name (compile)"
+        cat "$work/$name.log"
+        fail=1
+        continue
+    fi
+    "$work/quesim" "$work/$name.s" > /dev/null 2> "$work/$name.out"
+    if [ -n "$UPDATE" ]; then
+        cp "$work/$name.out" "$expected"
+        echo "updated $name"
+    elif diff -u "$expected" "$work/$name.out"; then
+        echo "ok   $name"
+    else
+        echo "FAIL $name"
+        fail=1
+    fi
+done
+exit $fail
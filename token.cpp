@@ -12,8 +12,9 @@ struct Token {
     TokenType type;
     std::string value;
     int line;
+    int column;
 
-    Token(TokenType t, const std::string &v, int l) : type(t), value(v), line(l) {}
+    Token(TokenType t, const std::string &v, int l, int c = 0) : type(t), value(v), line(l), column(c) {}
 };
 
 const std::unordered_set<std::string> keywords = {
@@ -26,10 +27,11 @@ class Tokenizer {
     std::string src;
     size_t pos = 0;
     int line = 1;
+    size_t lineStart = 0;
     bool debug;
 
 public:
-    Tokenizer(const std::string &input, bool dbg = false) : src(input), debug(dbg) {}
+    Tokenizer(std::string input, bool dbg = false) : src(std::move(input)), debug(dbg) {}
 
     char peek() {
         return pos < src.size() ? src[pos] : '\0';
@@ -37,8 +39,11 @@ public:
 
     char get() {
         char c = peek();
-        if (c == '\n') line++;
         pos++;
+        if (c == '\n') {
+            line++;
+            lineStart = pos;
+        }
         return c;
     }
 
@@ -48,24 +53,31 @@ public:
 
     Token nextToken() {
         skipWhitespace();
+        int col = (int)(pos - lineStart) + 1;
         char c = peek();
-        if (c == '\0') return Token(END, "", line);
+        if (c == '\0') return Token(END, "", line, col);
         if (c == '\n') {
             get();
-            return Token(NEWLINE, "\\n", line - 1);
+            return Token(NEWLINE, "\\n", line - 1, col);
         }
 
         if (isalpha(c) || c == '_') {
             std::string ident;
             while (isalnum(peek()) || peek() == '_') ident += get();
-            if (keywords.count(ident)) return Token(KEYWORD, ident, line);
-            return Token(IDENT, ident, line);
+            if (keywords.count(ident)) return Token(KEYWORD, ident, line, col);
+            return Token(IDENT, ident, line, col);
         }
 
         if (isdigit(c)) {
             std::string number;
+            number += get();
+            if (number == "0" && (peek() == 'x' || peek() == 'X')) {
+                number += get(); // literal hex, mis. alamat at(0x4000)
+                while (isxdigit(peek())) number += get();
+                return Token(NUMBER, number, line, col);
+            }
             while (isdigit(peek())) number += get();
-            return Token(NUMBER, number, line);
+            return Token(NUMBER, number, line, col);
         }
 
         if (c == '"') {
@@ -88,7 +100,7 @@ public:
                 }
             }
             get(); // closing "
-            return Token(STRING, str, line);
+            return Token(STRING, str, line, col);
         }
 
         // Symbols & operators
@@ -100,18 +112,14 @@ public:
             sym += get(); // Dapatkan '=' untuk kombinasi ==, !=, <=, >=
         }
 
-        return Token(SYMBOL, sym, line);
+        return Token(SYMBOL, sym, line, col);
     }
 
-    std::vector<Token> tokenize() {
-        std::vector<Token> tokens;
+    // Token berikutnya untuk TokenStream; --debug mencetaknya saat ditarik.
+    Token next() {
         Token tok = nextToken();
-        while (tok.type != END) {
-            if (debug) std::cout << "[" << tok.line << "] " << tok.value << " (" << tokTypeName(tok.type) << ")\n";
-            tokens.push_back(tok);
-            tok = nextToken();
-        }
-        return tokens;
+        if (debug && tok.type != END) std::cout << "[" << tok.line << "] " << tok.value << " (" << tokTypeName(tok.type) << ")\n";
+        return tok;
     }
 
     std::string tokTypeName(TokenType type) {
@@ -126,3 +134,46 @@ public:
         }
     }
 };
+
+// Token ditarik dari Tokenizer saat parser membutuhkannya dan disimpan di
+// ring kecil, jadi tidak ada vektor token untuk seluruh file. Referensi dari
+// peek()/get() tetap sah sampai Capacity - 1 token berikutnya ditarik.
+class TokenStream {
+    static constexpr size_t Capacity = 4; // pangkat dua
+    Tokenizer& source;
+    std::vector<Token> ring;
+    size_t head = 0;   // token berikutnya (hitungan absolut)
+    size_t filled = 0; // token yang sudah ditarik
+    bool done = false;
+    Token end;
+
+public:
+    explicit TokenStream(Tokenizer& t) : source(t), ring(Capacity, Token(END, "", 1, 0)), end(END, "", 1, 0) {}
+
+    // ahead maksimal Capacity - 2: slot token yang baru di-get() tidak ditimpa.
+    const Token& peek(size_t ahead = 0) {
+        while (!done && filled <= head + ahead) {
+            Token tok = source.next();
+            if (tok.type == END) {
+                done = true;
+                break;
+            }
+            end.line = tok.line; // END memakai baris token terakhir
+            ring[filled++ % Capacity] = std::move(tok);
+        }
+        return head + ahead < filled ? ring[(head + ahead) % Capacity] : end;
+    }
+
+    const Token& get() {
+        const Token& t = peek();
+        if (head < filled) ++head;
+        return t;
+    }
+
+    void advance() { get(); }
+
+    // Token terakhir yang diambil adalah NEWLINE (atau belum ada token).
+    bool atLineStart() const {
+        return head == 0 || ring[(head - 1) % Capacity].type == NEWLINE;
+    }
+};
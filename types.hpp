@@ -0,0 +1,252 @@
+#ifndef TYPES_HPP
+#define TYPES_HPP
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <map>
+#include <tuple>
+#include <stdexcept>
+#include <unordered_map>
+
+using TypeId = int;
+constexpr TypeId NoType = -1;
+
+enum class TypeKind {
+    Void, Bool, Int, Float, Str, Opaque,
+    Pointer, Slice, Array, Struct, Alias,
+    Vector, // vektor SIMD 128-bit: elem x count lane
+    Named // nama yang belum didefinisikan (struct/alias muncul belakangan)
+};
+
+struct TypeInfo {
+    TypeKind kind;
+    std::string name;     // nama tampilan, dibangun sekali saat intern
+    TypeId elem = NoType; // pointer/slice/array: elemen; alias: target
+    int count = 0;        // panjang array [T; N]
+    bool isSigned = false;
+    TypeId canon = NoType; // bentuk tanpa alias
+    int size = -1;        // -1: belum dihitung (struct/array menunggu layout)
+    int align = -1;
+};
+
+// Tipe di-intern sekali menjadi id kecil; perbandingan tipe = perbandingan id.
+// Pembuatan tipe baru dikunci mutex, pembacaan info per id tidak (id hanya
+// dibagikan setelah entrinya lengkap, dan blok penyimpanan tidak pernah dipindah).
+class TypeTable {
+    static constexpr int ChunkBits = 8;
+    static constexpr int ChunkSize = 1 << ChunkBits;
+    static constexpr int MaxChunks = 1024;
+
+    std::unique_ptr<TypeInfo[]> chunks[MaxChunks];
+    int count = 0;
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, TypeId> names;
+    std::map<std::tuple<TypeKind, TypeId, int>, TypeId> derived;
+    bool aliasesResolved = false;
+
+public:
+    TypeId Void, Bool, U8, U16, U32, U64, I8, I16, I32, I64, Int, Byte, Char, Float, Str, Any, Opaque, Error;
+    TypeId V16U8, V8U16, V4U32;
+
+    TypeTable() {
+        Void = primitive("void", TypeKind::Void, 0, false);
+        Bool = primitive("bool", TypeKind::Bool, 1, false);
+        U8 = primitive("u8", TypeKind::Int, 1, false);
+        U16 = primitive("u16", TypeKind::Int, 2, false);
+        U32 = primitive("u32", TypeKind::Int, 4, false);
+        U64 = primitive("u64", TypeKind::Int, 8, false);
+        I8 = primitive("i8", TypeKind::Int, 1, true);
+        I16 = primitive("i16", TypeKind::Int, 2, true);
+        I32 = primitive("i32", TypeKind::Int, 4, true);
+        I64 = primitive("i64", TypeKind::Int, 8, true);
+        Int = primitive("int", TypeKind::Int, 8, true);
+        Byte = primitive("byte", TypeKind::Int, 1, false);
+        Char = primitive("char", TypeKind::Int, 1, false);
+        Float = primitive("float", TypeKind::Float, 4, false);
+        Str = primitive("str", TypeKind::Str, 8, false);
+        Any = primitive("any", TypeKind::Opaque, 8, false);
+        Opaque = primitive("opaque", TypeKind::Opaque, 8, false);
+        Error = primitive("error", TypeKind::Opaque, 8, false);
+        V16U8 = vector("v16u8", U8, 16);
+        V8U16 = vector("v8u16", U16, 8);
+        V4U32 = vector("v4u32", U32, 4);
+    }
+
+    TypeId size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return count;
+    }
+
+    const TypeInfo& info(TypeId id) const { return chunks[id >> ChunkBits][id & (ChunkSize - 1)]; }
+    const std::string& name(TypeId id) const { return id == NoType ? noName() : info(id).name; }
+    TypeKind kind(TypeId id) const { return info(canonical(id)).kind; }
+
+    TypeId canonical(TypeId id) const {
+        if (id == NoType) return NoType;
+        const TypeInfo& t = info(id);
+        return t.canon != NoType ? t.canon : id;
+    }
+
+    bool same(TypeId a, TypeId b) const { return canonical(a) == canonical(b); }
+
+    // Nama tipe (primitif, struct, atau alias); dibuat sebagai Named bila belum dikenal.
+    TypeId named(const std::string& n) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = names.find(n);
+        if (it != names.end()) return it->second;
+        TypeInfo t;
+        t.kind = TypeKind::Named;
+        t.name = n;
+        TypeId id = add(t);
+        names.emplace(n, id);
+        return id;
+    }
+
+    // NoType jika nama belum pernah dipakai.
+    TypeId find(const std::string& n) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = names.find(n);
+        return it == names.end() ? NoType : it->second;
+    }
+
+    TypeId defineStruct(const std::string& n) {
+        TypeId id = named(n);
+        std::lock_guard<std::mutex> lock(mutex);
+        TypeInfo& t = at(id);
+        if (t.kind != TypeKind::Named) throw std::runtime_error("Type '" + n + "' is already defined");
+        t.kind = TypeKind::Struct;
+        return id;
+    }
+
+    TypeId defineAlias(const std::string& n, TypeId target) {
+        TypeId id = named(n);
+        std::lock_guard<std::mutex> lock(mutex);
+        TypeInfo& t = at(id);
+        if (t.kind != TypeKind::Named) throw std::runtime_error("Type '" + n + "' is already defined");
+        t.kind = TypeKind::Alias;
+        t.elem = target;
+        return id;
+    }
+
+    TypeId pointerTo(TypeId elem) { return derive(TypeKind::Pointer, elem, 0); }
+    TypeId sliceOf(TypeId elem) { return derive(TypeKind::Slice, elem, 0); }
+    TypeId arrayOf(TypeId elem, int n) { return derive(TypeKind::Array, elem, n); }
+
+    // Elemen pointer/slice/array (setelah alias dibuka); NoType untuk tipe lain.
+    TypeId element(TypeId id) const {
+        if (id == NoType) return NoType;
+        const TypeInfo& t = info(canonical(id));
+        return t.kind == TypeKind::Pointer || t.kind == TypeKind::Slice || t.kind == TypeKind::Array ? t.elem : NoType;
+    }
+
+    bool isInteger(TypeId id) const { return id != NoType && kind(id) == TypeKind::Int; }
+    bool isPointer(TypeId id) const { return id != NoType && kind(id) == TypeKind::Pointer; }
+    bool isStruct(TypeId id) const { return id != NoType && kind(id) == TypeKind::Struct; }
+    bool isArray(TypeId id) const { return id != NoType && kind(id) == TypeKind::Array; }
+    bool isVector(TypeId id) const { return id != NoType && kind(id) == TypeKind::Vector; }
+
+    // Tipe vektor berelemen elem (u8/u16/u32); NoType untuk elemen lain.
+    TypeId vectorOf(TypeId elem) const {
+        TypeId e = canonical(elem);
+        return e == U8 ? V16U8 : e == U16 ? V8U16 : e == U32 ? V4U32 : NoType;
+    }
+
+    // Elemen dan jumlah lane tipe vektor.
+    TypeId lane(TypeId id) const { return info(canonical(id)).elem; }
+    int lanes(TypeId id) const { return info(canonical(id)).count; }
+    bool isSigned(TypeId id) const { return id != NoType && info(canonical(id)).isSigned; }
+
+    // Dipanggil sekali setelah parsing: isi bentuk kanonik setiap tipe yang ada.
+    void resolveAliases() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (TypeId id = 0; id < count; ++id) canonicalize(id, 0);
+        aliasesResolved = true;
+    }
+
+    // Cache ukuran/alignment, diisi LayoutEngine.
+    void setLayout(TypeId id, int size, int align) {
+        std::lock_guard<std::mutex> lock(mutex);
+        at(id).size = size;
+        at(id).align = align;
+    }
+
+private:
+    static const std::string& noName() {
+        static const std::string s = "<unknown>";
+        return s;
+    }
+
+    TypeInfo& at(TypeId id) { return chunks[id >> ChunkBits][id & (ChunkSize - 1)]; }
+
+    TypeId add(const TypeInfo& t) {
+        if (count >= MaxChunks * ChunkSize) throw std::runtime_error("Too many types");
+        if (!chunks[count >> ChunkBits]) chunks[count >> ChunkBits].reset(new TypeInfo[ChunkSize]);
+        TypeId id = count++;
+        at(id) = t;
+        return id;
+    }
+
+    TypeId primitive(const std::string& n, TypeKind k, int size, bool sgn) {
+        TypeInfo t;
+        t.kind = k;
+        t.name = n;
+        t.size = size;
+        t.align = size ? size : 1;
+        t.isSigned = sgn;
+        TypeId id = add(t);
+        names.emplace(n, id);
+        return id;
+    }
+
+    TypeId vector(const std::string& n, TypeId elem, int lanes) {
+        TypeId id = primitive(n, TypeKind::Vector, 16, false);
+        at(id).elem = elem;
+        at(id).count = lanes;
+        return id;
+    }
+
+    TypeId derive(TypeKind k, TypeId elem, int n) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return deriveLocked(k, elem, n);
+    }
+
+    TypeId deriveLocked(TypeKind k, TypeId elem, int n) {
+        auto key = std::make_tuple(k, elem, n);
+        auto it = derived.find(key);
+        if (it != derived.end()) return it->second;
+        TypeInfo t;
+        t.kind = k;
+        t.elem = elem;
+        t.count = n;
+        const std::string& e = at(elem).name;
+        if (k == TypeKind::Pointer) t.name = "*" + e;
+        else if (k == TypeKind::Slice) t.name = "[" + e + "]";
+        else t.name = "[" + e + ";" + std::to_string(n) + "]";
+        if (k != TypeKind::Array) {
+            t.size = 8; // pointer dan slice tanpa panjang
+            t.align = 8;
+        }
+        TypeId id = add(t);
+        derived.emplace(key, id);
+        if (aliasesResolved) canonicalize(id, 0);
+        return id;
+    }
+
+    TypeId canonicalize(TypeId id, int depth) {
+        if (depth > 64) throw std::runtime_error("Recursive type alias: " + at(id).name);
+        TypeInfo& t = at(id);
+        if (t.canon != NoType) return t.canon;
+        TypeId c = id;
+        if (t.kind == TypeKind::Alias) {
+            c = canonicalize(t.elem, depth + 1);
+        } else if (t.kind == TypeKind::Pointer || t.kind == TypeKind::Slice || t.kind == TypeKind::Array) {
+            TypeId e = canonicalize(t.elem, depth + 1);
+            if (e != t.elem) c = deriveLocked(t.kind, e, t.count);
+        }
+        t.canon = c;
+        return c;
+    }
+};
+
+#endif